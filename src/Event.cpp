@@ -25,7 +25,7 @@ namespace KMC_Lattice {
 	}
 
 	void Event::calculateExecutionTime(const double rate) {
-		execution_time = sim_ptr->getTime() - (log(sim_ptr->rand01()) / rate);
+		execution_time = sim_ptr->getTime() + sim_ptr->randExp() / rate;
 	}
 
 	void Event::calculateRateConstant(const double input_rate) {
@@ -36,6 +36,10 @@ namespace KMC_Lattice {
 		return coords_dest;
 	}
 
+	int64_t Event::getDestSiteIndex() const {
+		return site_index_dest;
+	}
+
 	string Event::getEventType() const {
 		return event_type_base;
 	}
@@ -58,6 +62,12 @@ namespace KMC_Lattice {
 
 	void Event::setDestCoords(const Coords& coords) {
 		coords_dest = coords;
+		site_index_dest = -1;
+	}
+
+	void Event::setDestCoords(const Coords& coords, const int64_t site_index) {
+		coords_dest = coords;
+		site_index_dest = site_index;
 	}
 
 	bool Event::setExecutionTime(const double time) {
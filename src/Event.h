@@ -37,7 +37,8 @@ namespace KMC_Lattice {
 
 		//! \brief Calculates and sets the execution time of the event.
 		//! \details The function accesses the random number generator and current simulation time from the
-		//! Simulation object in order to calculate the execution time. When creating a new derived event class,
+		//! Simulation object in order to calculate the execution time, where the exponentially distributed waiting time
+		//! is generated using the ziggurat method. When creating a new derived event class,
 		//! one will often write a new calculateExecutionTime function that contains additional factors needed 
 		//! to calculate the rate. This base class function can then be called within the new function to calculate
 		//! the final execution time.
@@ -54,6 +55,11 @@ namespace KMC_Lattice {
 		//! \return The coordinates (-1,-1,-1) if no valid destination site has been set.
 		Coords getDestCoords() const;
 
+		//! \brief Gets the lattice site index of the event destination site.
+		//! \return the vector index of the destination site if it was set together with the destination coordinates.
+		//! \return -1 if no destination site index has been set.
+		int64_t getDestSiteIndex() const;
+
 		//! \brief Gets the name of event class.
 		//! \return "Event" when called on the base class.
 		virtual std::string getEventType() const;
@@ -81,9 +87,15 @@ namespace KMC_Lattice {
 		double getRateConstant() const;
 
 		//! \brief Sets the destination coordinates of the event.
+		//! \details The destination site index is reset to -1, because it no longer matches the new coordinates.
 		//! \param coords is the Coords struct that designates the input coordinates.
 		void setDestCoords(const Coords& coords);
 
+		//! \brief Sets the destination coordinates of the event and the matching lattice site index.
+		//! \param coords is the Coords struct that designates the input coordinates.
+		//! \param site_index is the vector index of the lattice site with the input coordinates.
+		void setDestCoords(const Coords& coords, const int64_t site_index);
+
 		//! \brief Sets the execution time of the event.
 		//! \param time is the input time.
 		//! \return true if the input time non-negative.
@@ -118,6 +130,7 @@ namespace KMC_Lattice {
 		Object* object_ptr = nullptr;
 		Object* object_target_ptr = nullptr;
 		Coords coords_dest = { -1,-1,-1 };
+		int64_t site_index_dest = -1;
 	};
 
 }
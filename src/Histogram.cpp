@@ -0,0 +1,143 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#include "Histogram.h"
+
+using namespace std;
+
+namespace KMC_Lattice {
+
+	Histogram::Histogram() {
+
+	}
+
+	Histogram::Histogram(const double bin_start, const double bin_size, const int num_bins) {
+		if (!(bin_size > 0) || !isfinite(bin_size) || !isfinite(bin_start)) {
+			cout << "Error! Cannot create histogram because the bin size is not greater than zero or the bin start is not finite." << endl;
+			throw invalid_argument("Error! Cannot create histogram because the bin size is not greater than zero or the bin start is not finite.");
+		}
+		if (num_bins < 1) {
+			cout << "Error! Cannot create histogram because the number of bins is less than 1." << endl;
+			throw invalid_argument("Error! Cannot create histogram because the number of bins is less than 1.");
+		}
+		Enable_auto_range = false;
+		Bin_size = bin_size;
+		Bin_origin = bin_start;
+		counts.assign(num_bins, 0);
+	}
+
+	Histogram::Histogram(const double bin_size) {
+		if (!(bin_size > 0) || !isfinite(bin_size)) {
+			cout << "Error! Cannot create histogram because the bin size is not greater than zero." << endl;
+			throw invalid_argument("Error! Cannot create histogram because the bin size is not greater than zero.");
+		}
+		Bin_size = bin_size;
+	}
+
+	vector<pair<double, double>> Histogram::calculateProbabilityHist() const {
+		if (N_samples == 0) {
+			cout << "Error! Cannot calculate probability histogram because no finite samples have been added." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because no finite samples have been added.");
+		}
+		auto bin_centers = getBinCenters();
+		vector<pair<double, double>> hist(counts.size(), make_pair(0.0, 0.0));
+		for (int i = 0; i < (int)counts.size(); i++) {
+			hist[i].first = bin_centers[i];
+			hist[i].second = (double)counts[i] / (double)N_samples;
+		}
+		return hist;
+	}
+
+	void Histogram::extendRange(const int64_t index) {
+		if (index < Bin_offset) {
+			counts.insert(counts.begin(), (size_t)(Bin_offset - index), 0);
+			Bin_offset = index;
+		}
+		else {
+			counts.resize((size_t)(index - Bin_offset + 1), 0);
+		}
+	}
+
+	vector<double> Histogram::getBinCenters() const {
+		double bin_start = getBinStart();
+		vector<double> bin_centers(counts.size());
+		for (int i = 0; i < (int)counts.size(); i++) {
+			bin_centers[i] = bin_start + 0.5*Bin_size + Bin_size * i;
+		}
+		return bin_centers;
+	}
+
+	double Histogram::getBinSize() const {
+		return Bin_size;
+	}
+
+	double Histogram::getBinStart() const {
+		return (Bin_offset == 0) ? Bin_origin : Bin_origin + Bin_size * Bin_offset;
+	}
+
+	vector<int64_t> Histogram::getCounts() const {
+		return counts;
+	}
+
+	int Histogram::getNumBins() const {
+		return (int)counts.size();
+	}
+
+	int64_t Histogram::getNumInvalidSamples() const {
+		return N_invalid;
+	}
+
+	int64_t Histogram::getNumOutOfRangeSamples() const {
+		return N_out_of_range;
+	}
+
+	int64_t Histogram::getNumSamples() const {
+		return N_samples;
+	}
+
+	bool Histogram::isAutoRangeEnabled() const {
+		return Enable_auto_range;
+	}
+
+	void Histogram::merge(const Histogram& input) {
+		bool is_compatible = (input.Enable_auto_range == Enable_auto_range && input.Bin_size == Bin_size);
+		if (is_compatible && !Enable_auto_range) {
+			is_compatible = (input.Bin_origin == Bin_origin && input.counts.size() == counts.size());
+		}
+		if (is_compatible && Enable_auto_range && !counts.empty() && !input.counts.empty()) {
+			is_compatible = (input.Bin_origin == Bin_origin);
+		}
+		if (!is_compatible) {
+			cout << "Error! The histograms cannot be merged because they have different bins." << endl;
+			throw invalid_argument("Error! The histograms cannot be merged because they have different bins.");
+		}
+		N_samples += input.N_samples;
+		N_invalid += input.N_invalid;
+		N_out_of_range += input.N_out_of_range;
+		if (input.counts.empty()) {
+			return;
+		}
+		if (counts.empty()) {
+			Bin_origin = input.Bin_origin;
+			Bin_offset = input.Bin_offset;
+			counts = input.counts;
+			return;
+		}
+		// Extend the automatic range bins to cover the bins of the input histogram
+		if (Enable_auto_range) {
+			if (input.Bin_offset < Bin_offset) {
+				extendRange(input.Bin_offset);
+			}
+			int64_t index_last = input.Bin_offset + (int64_t)input.counts.size() - 1;
+			if (index_last >= Bin_offset + (int64_t)counts.size()) {
+				extendRange(index_last);
+			}
+		}
+		for (int64_t i = 0; i < (int64_t)input.counts.size(); i++) {
+			counts[input.Bin_offset - Bin_offset + i] += input.counts[i];
+		}
+	}
+
+}
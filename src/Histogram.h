@@ -0,0 +1,261 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software package.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#ifndef KMC_LATTICE_HISTOGRAM_H
+#define KMC_LATTICE_HISTOGRAM_H
+
+#include "Utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace KMC_Lattice {
+
+	//! \brief This class accumulates a histogram of samples that are added one at a time or in batches without storing the samples.
+	//! \details The histogram can use a fixed set of bins or automatically extend its range to fit the samples. With fixed bins, samples
+	//! outside of the bin range are counted as out of range, and a sample at the upper edge of the last bin is placed in the last bin. With
+	//! automatic ranging, the bins are aligned to the first sample and new bins are added at either end as needed, so the memory usage
+	//! grows with the range of the samples divided by the bin size. Samples that are not finite are counted separately and are not binned.
+	//! The probability of each bin is calculated relative to the number of finite samples.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class Histogram {
+	public:
+		//! Default constructor that creates an empty Histogram object that automatically extends its range with a bin size of one.
+		Histogram();
+
+		//! \brief Constructor that creates a Histogram object with a fixed set of bins.
+		//! \param bin_start is the lower edge of the first bin.
+		//! \param bin_size is the width of each bin, which must be greater than zero.
+		//! \param num_bins is the number of bins, which must be greater than zero.
+		Histogram(const double bin_start, const double bin_size, const int num_bins);
+
+		//! \brief Constructor that creates a Histogram object that automatically extends its range to fit the samples.
+		//! \param bin_size is the width of each bin, which must be greater than zero.
+		explicit Histogram(const double bin_size);
+
+		//! \brief Adds the input sample to the histogram.
+		//! \param value is the input sample.
+		void addSample(const double value);
+
+		//! \brief Adds all of the samples in the input data vector to the histogram.
+		//! \param data is the input data vector.
+		template<typename T>
+		void addSamples(const std::vector<T>& data);
+
+		//! \brief Adds all of the samples in the input data vector to the histogram using multiple threads.
+		//! \details Each thread counts a contiguous block of the data in thread-local bins, and the thread-local counts are merged at the end,
+		//! so the result is the same as for the single-threaded function for any number of threads. In the automatic range mode, the bins of
+		//! all threads are aligned to the first finite sample, and each thread finds the range of its block while counting it in a single pass.
+		//! \param data is the input data vector.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		template<typename T>
+		void addSamples(const std::vector<T>& data, const int num_threads);
+
+		//! \brief Calculates the probability histogram of the samples that have been added.
+		//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+		std::vector<std::pair<double, double>> calculateProbabilityHist() const;
+
+		//! \brief Calculates the number of finite values and the range of the finite values of the input data vector in a single pass.
+		//! \param data is the input data vector.
+		//! \param min_val is set to the smallest finite value and is not changed when there are no finite values.
+		//! \param max_val is set to the largest finite value and is not changed when there are no finite values.
+		//! \returns the number of finite values in the data vector.
+		template<typename T>
+		static int64_t calculateRange(const std::vector<T>& data, T& min_val, T& max_val);
+
+		//! \brief Calculates the number of finite values and the range of the finite values of the input data vector using multiple threads.
+		//! \details Each thread scans a contiguous block of the data in a single pass, and the results of the blocks are combined at the end.
+		//! \param data is the input data vector.
+		//! \param min_val is set to the smallest finite value and is not changed when there are no finite values.
+		//! \param max_val is set to the largest finite value and is not changed when there are no finite values.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		//! \returns the number of finite values in the data vector.
+		template<typename T>
+		static int64_t calculateRange(const std::vector<T>& data, T& min_val, T& max_val, const int num_threads);
+
+		//! \brief Gets the bin-centered x values of the bins.
+		std::vector<double> getBinCenters() const;
+
+		//! \brief Gets the width of each bin.
+		double getBinSize() const;
+
+		//! \brief Gets the lower edge of the first bin.
+		double getBinStart() const;
+
+		//! \brief Gets the number of samples in each bin.
+		std::vector<int64_t> getCounts() const;
+
+		//! \brief Gets the number of bins.
+		int getNumBins() const;
+
+		//! \brief Gets the number of samples that were not finite and were not added to the histogram.
+		int64_t getNumInvalidSamples() const;
+
+		//! \brief Gets the number of finite samples that were outside of the fixed bin range.
+		int64_t getNumOutOfRangeSamples() const;
+
+		//! \brief Gets the number of finite samples that have been added, including the samples that were out of range.
+		int64_t getNumSamples() const;
+
+		//! \brief Checks whether or not the histogram automatically extends its range to fit the samples.
+		bool isAutoRangeEnabled() const;
+
+		//! \brief Adds the counts of the input histogram to this histogram.
+		//! \details Both histograms must use the same bin size and bin mode. Fixed bins must also have the same bin start and number of
+		//! bins, and histograms in the automatic range mode must have their bins aligned to the same first sample unless one of them is empty.
+		//! \param input is the histogram that will be merged into this one.
+		void merge(const Histogram& input);
+
+	private:
+		bool Enable_auto_range = true;
+		double Bin_size = 1.0;
+		// Lower edge of the bin with index zero, which is the first sample in the automatic range mode
+		double Bin_origin = 0.0;
+		// Index of the first bin relative to the origin
+		int64_t Bin_offset = 0;
+		std::vector<int64_t> counts;
+		int64_t N_samples = 0;
+		int64_t N_invalid = 0;
+		int64_t N_out_of_range = 0;
+
+		// Extends the bins of the automatic range mode so that they include the input bin index relative to the origin.
+		void extendRange(const int64_t index);
+
+		// Adds the samples in the input index range of the data vector to the histogram.
+		template<typename T>
+		void addSamples(const std::vector<T>& data, const int64_t index_start, const int64_t index_end);
+
+		// Calculates the number of finite values and their range in the input index range of the data vector.
+		template<typename T>
+		static int64_t calculateRange(const std::vector<T>& data, const int64_t index_start, const int64_t index_end, T& min_val, T& max_val);
+	};
+
+	inline void Histogram::addSample(const double value) {
+		if (!std::isfinite(value)) {
+			N_invalid++;
+			return;
+		}
+		N_samples++;
+		if (Enable_auto_range) {
+			if (counts.empty()) {
+				Bin_origin = value;
+				Bin_offset = 0;
+				counts.assign(1, 0);
+			}
+			int64_t index = (int64_t)std::floor((value - Bin_origin) / Bin_size);
+			if (index < Bin_offset || index >= Bin_offset + (int64_t)counts.size()) {
+				extendRange(index);
+			}
+			counts[index - Bin_offset]++;
+			return;
+		}
+		int num_bins = (int)counts.size();
+		if (value < Bin_origin || value > Bin_origin + num_bins * Bin_size) {
+			N_out_of_range++;
+			return;
+		}
+		// Place samples at the upper edge of the last bin, including those where rounding gives an index past the last bin, in the last bin
+		int index = std::min((int)std::floor((value - Bin_origin) / Bin_size), num_bins - 1);
+		counts[index]++;
+	}
+
+	template<typename T>
+	void Histogram::addSamples(const std::vector<T>& data) {
+		addSamples(data, 0, (int64_t)data.size());
+	}
+
+	template<typename T>
+	void Histogram::addSamples(const std::vector<T>& data, const int num_threads) {
+		if (Enable_auto_range && counts.empty()) {
+			// Align the bins to the first finite sample in the same way as the single-threaded function
+			auto it = std::find_if(data.begin(), data.end(), [](const T value) { return std::isfinite((double)value); });
+			if (it == data.end()) {
+				N_invalid += (int64_t)data.size();
+				return;
+			}
+			Bin_origin = (double)*it;
+			Bin_offset = 0;
+			counts.assign(1, 0);
+		}
+		std::mutex merge_mutex;
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			Histogram hist_local = Enable_auto_range ? Histogram(Bin_size) : Histogram(Bin_origin, Bin_size, (int)counts.size());
+			if (Enable_auto_range) {
+				hist_local.Bin_origin = Bin_origin;
+				hist_local.counts.assign(1, 0);
+			}
+			hist_local.addSamples(data, index_start, index_end);
+			std::lock_guard<std::mutex> lock(merge_mutex);
+			merge(hist_local);
+		});
+	}
+
+	template<typename T>
+	void Histogram::addSamples(const std::vector<T>& data, const int64_t index_start, const int64_t index_end) {
+		for (int64_t i = index_start; i < index_end; i++) {
+			addSample((double)data[i]);
+		}
+	}
+
+	template<typename T>
+	int64_t Histogram::calculateRange(const std::vector<T>& data, T& min_val, T& max_val) {
+		return calculateRange(data, 0, (int64_t)data.size(), min_val, max_val);
+	}
+
+	template<typename T>
+	int64_t Histogram::calculateRange(const std::vector<T>& data, T& min_val, T& max_val, const int num_threads) {
+		std::mutex merge_mutex;
+		int64_t num_finite = 0;
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			T min_local, max_local;
+			int64_t num_local = calculateRange(data, index_start, index_end, min_local, max_local);
+			if (num_local == 0) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(merge_mutex);
+			if (num_finite == 0 || min_local < min_val) {
+				min_val = min_local;
+			}
+			if (num_finite == 0 || max_local > max_val) {
+				max_val = max_local;
+			}
+			num_finite += num_local;
+		});
+		return num_finite;
+	}
+
+	template<typename T>
+	int64_t Histogram::calculateRange(const std::vector<T>& data, const int64_t index_start, const int64_t index_end, T& min_val, T& max_val) {
+		int64_t num_finite = 0;
+		for (int64_t i = index_start; i < index_end; i++) {
+			const T item = data[i];
+			if (!std::isfinite((double)item)) {
+				continue;
+			}
+			if (num_finite == 0) {
+				min_val = item;
+				max_val = item;
+			}
+			else if (item < min_val) {
+				min_val = item;
+			}
+			else if (item > max_val) {
+				max_val = item;
+			}
+			num_finite++;
+		}
+		return num_finite;
+	}
+
+}
+
+#endif // KMC_LATTICE_HISTOGRAM_H
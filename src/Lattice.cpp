@@ -4,6 +4,11 @@
 // The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
 
 #include "Lattice.h"
+#include <climits>
+#include <unordered_set>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
@@ -13,212 +18,502 @@ namespace KMC_Lattice {
 
 	}
 
-	void Lattice::init(const Parameters_Lattice& params, mt19937_64* generator_ptr) {
+	void Lattice::init(const Parameters_Lattice& params, RandomEngine* generator_ptr) {
 		if (!params.checkParameters()) {
 			throw invalid_argument("Error! Input lattice parameters are invalid");
 		}
 		Enable_periodic_x = params.Enable_periodic_x;
 		Enable_periodic_y = params.Enable_periodic_y;
 		Enable_periodic_z = params.Enable_periodic_z;
+		Periodicity_mode = (Enable_periodic_x ? 4 : 0) + (Enable_periodic_y ? 2 : 0) + (Enable_periodic_z ? 1 : 0);
 		Length = params.Length;
 		Width = params.Width;
 		Height = params.Height;
 		Unit_size = params.Unit_size;
-		site_ptrs.assign(Length*Width*Height, nullptr);
+		// Setup the bit shifts and masks used when all lattice dimensions are powers of two
+		int log2_length = calculateLog2(Length);
+		int log2_width = calculateLog2(Width);
+		int log2_height = calculateLog2(Height);
+		Power_of_two = (log2_length >= 0 && log2_width >= 0 && log2_height >= 0);
+		if (Power_of_two) {
+			Index_shift_x = log2_width + log2_height;
+			Index_shift_y = log2_height;
+			Wrap_mask_x = Enable_periodic_x ? Length - 1 : -1;
+			Wrap_mask_y = Enable_periodic_y ? Width - 1 : -1;
+			Wrap_mask_z = Enable_periodic_z ? Height - 1 : -1;
+		}
+		// In sparse storage mode, the site pointer vector is not allocated and the occupied sites are stored in the site map
+		Enable_sparse_storage = params.Enable_sparse_storage;
+		site_map.clear();
+		sparse_site_ptrs.clear();
+		if (Enable_sparse_storage) {
+			vector<Site*>().swap(site_ptrs);
+		}
+		else {
+			site_ptrs.assign((size_t)getNumSites(), nullptr);
+		}
 		gen_ptr = generator_ptr;
+		sampler_x.setRange((uint32_t)Length);
+		sampler_y.setRange((uint32_t)Width);
+		sampler_z.setRange((uint32_t)Height);
+		// The displacement tables depend on the lattice dimensions and must be constructed again after initialization
+		Displacement_cutoff = 0;
+		displacement_table.clear();
+		// The free site index starts with every site unoccupied and is built again from the site occupancy when the site pointers are set
+		Enable_free_site_index = params.Enable_free_site_index && !Enable_sparse_storage;
+		free_site_indices.clear();
+		free_site_positions.clear();
+		if (Enable_free_site_index) {
+			free_site_indices.resize((size_t)getNumSites());
+			free_site_positions.resize((size_t)getNumSites());
+			for (int64_t n = 0; n < getNumSites(); n++) {
+				free_site_indices[n] = n;
+				free_site_positions[n] = n;
+			}
+		}
+		Enable_neighbor_counts = params.Enable_neighbor_counts;
+		neighbor_counts.clear();
+		if (Enable_neighbor_counts) {
+			neighbor_counts.assign((size_t)getNumSites(), 0);
+		}
+		Enable_site_energies = params.Enable_site_energies;
+		site_energies.clear();
+		if (Enable_site_energies) {
+			site_energies.assign((size_t)getNumSites(), 0.0f);
+		}
+		Enable_site_states = params.Enable_site_states;
+		site_types.clear();
+		site_species.clear();
+		if (Enable_site_states) {
+			site_types.assign((size_t)getNumSites(), 0);
+			site_species.assign((size_t)getNumSites(), 0);
+		}
 	}
 
 	void Lattice::calculateDestinationCoords(const Coords& coords_initial, const int i, const int j, const int k, Coords& coords_dest) const {
-		coords_dest.x = coords_initial.x + i + calculateDX(coords_initial.x, i);
-		coords_dest.y = coords_initial.y + j + calculateDY(coords_initial.y, j);
-		coords_dest.z = coords_initial.z + k + calculateDZ(coords_initial.z, k);
+		if (Power_of_two) {
+			// The wrap masks are all ones in directions without periodic boundaries
+			coords_dest.x = (coords_initial.x + i) & Wrap_mask_x;
+			coords_dest.y = (coords_initial.y + j) & Wrap_mask_y;
+			coords_dest.z = (coords_initial.z + k) & Wrap_mask_z;
+			return;
+		}
+		switch (Periodicity_mode) {
+		case 0:
+			calculateDestinationCoords<false, false, false>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 1:
+			calculateDestinationCoords<false, false, true>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 2:
+			calculateDestinationCoords<false, true, false>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 3:
+			calculateDestinationCoords<false, true, true>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 4:
+			calculateDestinationCoords<true, false, false>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 5:
+			calculateDestinationCoords<true, false, true>(coords_initial, i, j, k, coords_dest);
+			break;
+		case 6:
+			calculateDestinationCoords<true, true, false>(coords_initial, i, j, k, coords_dest);
+			break;
+		default:
+			calculateDestinationCoords<true, true, true>(coords_initial, i, j, k, coords_dest);
+			break;
+		}
 	}
 
 	int Lattice::calculateDX(const int x, const int i) const {
-		if (Enable_periodic_x && x + i < 0) {
-			return Length;
-		}
-		else if (Enable_periodic_x && x + i >= Length) {
-			return -Length;
-		}
-		else {
-			return 0;
-		}
+		return Enable_periodic_x ? calculateBoundaryCorrection<true>(x + i, Length) : 0;
 	}
 
 	int Lattice::calculateDX(const Coords& coords_initial, const Coords& coords_dest) const {
-		if (Enable_periodic_x && 2 * (coords_dest.x - coords_initial.x) > Length) {
-			return Length;
-		}
-		else if (Enable_periodic_x && 2 * (coords_dest.x - coords_initial.x) < -Length) {
-			return -Length;
-		}
-		else {
-			return 0;
-		}
+		return Enable_periodic_x ? calculateImageCorrection<true>(coords_dest.x - coords_initial.x, Length) : 0;
 	}
 
 	int Lattice::calculateDY(const int y, const int j) const {
-		if (Enable_periodic_y && y + j < 0) {
-			return Width;
-		}
-		else if (Enable_periodic_y && y + j >= Width) {
-			return -Width;
-		}
-		else {
-			return 0;
-		}
+		return Enable_periodic_y ? calculateBoundaryCorrection<true>(y + j, Width) : 0;
 	}
 
 	int Lattice::calculateDY(const Coords& coords_initial, const Coords& coords_dest) const {
-		if (Enable_periodic_y && 2 * (coords_dest.y - coords_initial.y) > Width) {
-			return Width;
-		}
-		else if (Enable_periodic_y && 2 * (coords_dest.y - coords_initial.y) < -Width) {
-			return -Width;
-		}
-		else {
-			return 0;
-		}
+		return Enable_periodic_y ? calculateImageCorrection<true>(coords_dest.y - coords_initial.y, Width) : 0;
 	}
 
 	int Lattice::calculateDZ(const int z, const int k) const {
-		if (Enable_periodic_z && z + k < 0) {
-			return Height;
-		}
-		else if (Enable_periodic_z && z + k >= Height) {
-			return -Height;
-		}
-		else {
-			return 0;
-		}
+		return Enable_periodic_z ? calculateBoundaryCorrection<true>(z + k, Height) : 0;
 	}
 
 	int Lattice::calculateDZ(const Coords& coords_initial, const Coords& coords_dest) const {
-		if (Enable_periodic_z && 2 * (coords_dest.z - coords_initial.z) > Height) {
-			return Height;
-		}
-		else if (Enable_periodic_z && 2 * (coords_dest.z - coords_initial.z) < -Height) {
-			return -Height;
+		return Enable_periodic_z ? calculateImageCorrection<true>(coords_dest.z - coords_initial.z, Height) : 0;
+	}
+
+	int Lattice::calculateLog2(const int value) {
+		if (value <= 0 || (value & (value - 1)) != 0) {
+			return -1;
 		}
-		else {
-			return 0;
+		int log2_value = 0;
+		while ((1 << log2_value) < value) {
+			log2_value++;
 		}
+		return log2_value;
 	}
 
 	int Lattice::calculateLatticeDistanceSquared(const Coords& coords_start, const Coords& coords_dest) const {
-		int absx = abs(coords_dest.x - coords_start.x);
-		int absy = abs(coords_dest.y - coords_start.y);
-		int absz = abs(coords_dest.z - coords_start.z);
-		int dx, dy, dz;
-		if (Enable_periodic_x && 2 * absx > Length) {
-			dx = -Length;
+		if (Displacement_cutoff > 0) {
+			return image_delta_sq_x[coords_dest.x - coords_start.x + Length - 1] + image_delta_sq_y[coords_dest.y - coords_start.y + Width - 1] + image_delta_sq_z[coords_dest.z - coords_start.z + Height - 1];
+		}
+		switch (Periodicity_mode) {
+		case 0:
+			return calculateLatticeDistanceSquared<false, false, false>(coords_start, coords_dest);
+		case 1:
+			return calculateLatticeDistanceSquared<false, false, true>(coords_start, coords_dest);
+		case 2:
+			return calculateLatticeDistanceSquared<false, true, false>(coords_start, coords_dest);
+		case 3:
+			return calculateLatticeDistanceSquared<false, true, true>(coords_start, coords_dest);
+		case 4:
+			return calculateLatticeDistanceSquared<true, false, false>(coords_start, coords_dest);
+		case 5:
+			return calculateLatticeDistanceSquared<true, false, true>(coords_start, coords_dest);
+		case 6:
+			return calculateLatticeDistanceSquared<true, true, false>(coords_start, coords_dest);
+		default:
+			return calculateLatticeDistanceSquared<true, true, true>(coords_start, coords_dest);
+		}
+	}
+
+	void Lattice::calculateLatticeDistanceSquared(const Coords& coords_start, const int* x, const int* y, const int* z, const int num_coords, int* distances_sq) const {
+		// The minimum image separation is min(|d|, period - |d|), so a very large period disables wrapping in non-periodic directions
+		const int period_x = Enable_periodic_x ? Length : INT_MAX;
+		const int period_y = Enable_periodic_y ? Width : INT_MAX;
+		const int period_z = Enable_periodic_z ? Height : INT_MAX;
+		int n = 0;
+#if defined(__AVX2__)
+		const __m256i start_x8 = _mm256_set1_epi32(coords_start.x);
+		const __m256i start_y8 = _mm256_set1_epi32(coords_start.y);
+		const __m256i start_z8 = _mm256_set1_epi32(coords_start.z);
+		const __m256i period_x8 = _mm256_set1_epi32(period_x);
+		const __m256i period_y8 = _mm256_set1_epi32(period_y);
+		const __m256i period_z8 = _mm256_set1_epi32(period_z);
+		for (; n + 8 <= num_coords; n += 8) {
+			__m256i dx = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(x + n)), start_x8));
+			__m256i dy = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(y + n)), start_y8));
+			__m256i dz = _mm256_abs_epi32(_mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(z + n)), start_z8));
+			dx = _mm256_min_epi32(dx, _mm256_sub_epi32(period_x8, dx));
+			dy = _mm256_min_epi32(dy, _mm256_sub_epi32(period_y8, dy));
+			dz = _mm256_min_epi32(dz, _mm256_sub_epi32(period_z8, dz));
+			__m256i result = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy)), _mm256_mullo_epi32(dz, dz));
+			_mm256_storeu_si256((__m256i*)(distances_sq + n), result);
+		}
+#elif defined(__SSE4_1__)
+		const __m128i start_x4 = _mm_set1_epi32(coords_start.x);
+		const __m128i start_y4 = _mm_set1_epi32(coords_start.y);
+		const __m128i start_z4 = _mm_set1_epi32(coords_start.z);
+		const __m128i period_x4 = _mm_set1_epi32(period_x);
+		const __m128i period_y4 = _mm_set1_epi32(period_y);
+		const __m128i period_z4 = _mm_set1_epi32(period_z);
+		for (; n + 4 <= num_coords; n += 4) {
+			__m128i dx = _mm_abs_epi32(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)(x + n)), start_x4));
+			__m128i dy = _mm_abs_epi32(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)(y + n)), start_y4));
+			__m128i dz = _mm_abs_epi32(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)(z + n)), start_z4));
+			dx = _mm_min_epi32(dx, _mm_sub_epi32(period_x4, dx));
+			dy = _mm_min_epi32(dy, _mm_sub_epi32(period_y4, dy));
+			dz = _mm_min_epi32(dz, _mm_sub_epi32(period_z4, dz));
+			__m128i result = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(dx, dx), _mm_mullo_epi32(dy, dy)), _mm_mullo_epi32(dz, dz));
+			_mm_storeu_si128((__m128i*)(distances_sq + n), result);
+		}
+#endif
+		// Scalar loop for the remaining coordinates or when vector instructions are not enabled
+		for (; n < num_coords; n++) {
+			int dx = abs(x[n] - coords_start.x);
+			int dy = abs(y[n] - coords_start.y);
+			int dz = abs(z[n] - coords_start.z);
+			dx = min(dx, period_x - dx);
+			dy = min(dy, period_y - dy);
+			dz = min(dz, period_z - dz);
+			distances_sq[n] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	void Lattice::calculateHopEnergyDifferences(const Coords& coords, int64_t* dest_indices, float* energy_diffs) const {
+		checkSiteEnergies();
+		const int num_displacements = (int)hop_displacements.size();
+		for (int n = 0; n < num_displacements; n++) {
+			dest_indices[n] = calculateHopDestinationIndex(coords, hop_displacements[n]);
+		}
+		// Separating the index calculation from the energy lookup allows the compiler to vectorize this loop with gather instructions,
+		// so invalid destinations load the energy of site 0 and are then replaced without branching
+		const float energy_start = site_energies[getSiteIndexUnchecked(coords)];
+		const float* energies = site_energies.data();
+		const float infinity = numeric_limits<float>::infinity();
+		for (int n = 0; n < num_displacements; n++) {
+			float energy_diff = energies[max(dest_indices[n], (int64_t)0)] - energy_start;
+			energy_diffs[n] = (dest_indices[n] >= 0) ? energy_diff : infinity;
 		}
-		else {
-			dx = 0;
+	}
+
+	bool Lattice::checkMoveValidity(const Coords& coords_initial, const int i, const int j, const int k) const {
+		switch (Periodicity_mode) {
+		case 0:
+			return checkMoveValidity<false, false, false>(coords_initial, i, j, k);
+		case 1:
+			return checkMoveValidity<false, false, true>(coords_initial, i, j, k);
+		case 2:
+			return checkMoveValidity<false, true, false>(coords_initial, i, j, k);
+		case 3:
+			return checkMoveValidity<false, true, true>(coords_initial, i, j, k);
+		case 4:
+			return checkMoveValidity<true, false, false>(coords_initial, i, j, k);
+		case 5:
+			return checkMoveValidity<true, false, true>(coords_initial, i, j, k);
+		case 6:
+			return checkMoveValidity<true, true, false>(coords_initial, i, j, k);
+		default:
+			return checkMoveValidity<true, true, true>(coords_initial, i, j, k);
 		}
-		if (Enable_periodic_y && 2 * absy > Width) {
-			dy = -Width;
+	}
+
+	Coords Lattice::chooseRandomUnoccupiedNeighbor(const Coords& coords_i) {
+		switch (Periodicity_mode) {
+		case 0:
+			return chooseRandomUnoccupiedNeighbor<false, false, false>(coords_i);
+		case 1:
+			return chooseRandomUnoccupiedNeighbor<false, false, true>(coords_i);
+		case 2:
+			return chooseRandomUnoccupiedNeighbor<false, true, false>(coords_i);
+		case 3:
+			return chooseRandomUnoccupiedNeighbor<false, true, true>(coords_i);
+		case 4:
+			return chooseRandomUnoccupiedNeighbor<true, false, false>(coords_i);
+		case 5:
+			return chooseRandomUnoccupiedNeighbor<true, false, true>(coords_i);
+		case 6:
+			return chooseRandomUnoccupiedNeighbor<true, true, false>(coords_i);
+		default:
+			return chooseRandomUnoccupiedNeighbor<true, true, true>(coords_i);
+		}
+	}
+
+	int64_t Lattice::chooseRandomUnoccupiedNeighbor(const int64_t site_index) {
+		int64_t neighbor_indices[6];
+		int num_neighbors = findNeighborIndices(site_index, neighbor_indices);
+		int num_unoccupied = 0;
+		for (int n = 0; n < num_neighbors; n++) {
+			if (!isOccupied(neighbor_indices[n])) {
+				neighbor_indices[num_unoccupied++] = neighbor_indices[n];
+			}
 		}
-		else {
-			dy = 0;
+		if (num_unoccupied == 1) {
+			return neighbor_indices[0];
 		}
-		if (Enable_periodic_z && 2 * absz > Height) {
-			dz = -Height;
+		else if (num_unoccupied > 1) {
+			return neighbor_indices[BoundedSampler32::generate(*gen_ptr, (uint32_t)num_unoccupied)];
 		}
 		else {
-			dz = 0;
+			return -1;
 		}
-		return (absx + dx)*(absx + dx) + (absy + dy)*(absy + dy) + (absz + dz)*(absz + dz);
 	}
 
-	bool Lattice::checkMoveValidity(const Coords& coords_initial, const int i, const int j, const int k) const {
-		if (i == 0 && j == 0 && k == 0) {
-			return false;
+	Coords Lattice::chooseRandomUnoccupiedSite() {
+		if (Enable_free_site_index) {
+			if (free_site_indices.empty()) {
+				return Coords(-1, -1, -1);
+			}
+			return getSiteCoords(free_site_indices[BoundedSampler64::generate(*gen_ptr, (uint64_t)free_site_indices.size())]);
 		}
-		if (!Enable_periodic_x && (coords_initial.x + i >= Length || coords_initial.x + i < 0)) {
-			return false;
+		// Rejection sampling is fast at low occupancy, so only scan the lattice when it repeatedly fails
+		for (int n = 0; n < 100; n++) {
+			Coords coords = generateRandomCoords();
+			if (!isOccupied(coords)) {
+				return coords;
+			}
 		}
-		if (!Enable_periodic_y && (coords_initial.y + j >= Width || coords_initial.y + j < 0)) {
-			return false;
+		vector<int64_t> unoccupied_indices;
+		for (int64_t n = 0; n < getNumSites(); n++) {
+			if (!isOccupied(n)) {
+				unoccupied_indices.push_back(n);
+			}
 		}
-		if (!Enable_periodic_z && (coords_initial.z + k >= Height || coords_initial.z + k < 0)) {
-			return false;
+		if (unoccupied_indices.empty()) {
+			return Coords(-1, -1, -1);
 		}
-		return true;
+		return getSiteCoords(unoccupied_indices[BoundedSampler64::generate(*gen_ptr, (uint64_t)unoccupied_indices.size())]);
 	}
 
-	Coords Lattice::chooseRandomUnoccupiedNeighbor(const Coords& coords_i) {
+	vector<Coords> Lattice::chooseRandomUnoccupiedSites(const int num_sites) {
+		if (num_sites < 0 || num_sites > getNumUnoccupiedSites()) {
+			cout << "Error! The number of requested unoccupied sites is negative or larger than the number of unoccupied sites in the lattice." << endl;
+			throw invalid_argument("The number of requested unoccupied sites is negative or larger than the number of unoccupied sites in the lattice.");
+		}
 		vector<Coords> coords_vec;
-		coords_vec.reserve(6);
-		Coords coords_f;
-		for (int n = 0; n < 6; n++) {
-			int i = 0;
-			int j = 0;
-			int k = 0;
-			if (n == 0) {
-				i = -1;
+		coords_vec.reserve(num_sites);
+		if (Enable_free_site_index) {
+			// Partial Fisher-Yates shuffle of the free site index that keeps the site positions up to date
+			int64_t num_free = (int64_t)free_site_indices.size();
+			for (int64_t n = 0; n < num_sites; n++) {
+				int64_t m = n + (int64_t)BoundedSampler64::generate(*gen_ptr, (uint64_t)(num_free - n));
+				swap(free_site_indices[n], free_site_indices[m]);
+				free_site_positions[free_site_indices[n]] = n;
+				free_site_positions[free_site_indices[m]] = m;
+				coords_vec.push_back(getSiteCoords(free_site_indices[n]));
 			}
-			else if (n == 1) {
-				i = 1;
-			}
-			else if (n == 2) {
-				j = -1;
-			}
-			else if (n == 3) {
-				j = 1;
-			}
-			else if (n == 4) {
-				k = -1;
-			}
-			else if (n == 5) {
-				k = 1;
-			}
-			if (checkMoveValidity(coords_i, i, j, k)) {
-				calculateDestinationCoords(coords_i, i, j, k, coords_f);
-				if (!isOccupied(coords_f)) {
-					coords_vec.push_back(coords_f);
+			return coords_vec;
+		}
+		if (Enable_sparse_storage) {
+			// Sparse lattices are dilute, so rejection sampling quickly finds distinct unoccupied sites without scanning the lattice
+			BoundedSampler64 sampler_sites((uint64_t)getNumSites());
+			unordered_set<int64_t> chosen_indices;
+			chosen_indices.reserve(num_sites);
+			while ((int)chosen_indices.size() < num_sites) {
+				int64_t site_index = (int64_t)sampler_sites.generate(*gen_ptr);
+				if (!isOccupied(site_index) && chosen_indices.insert(site_index).second) {
+					coords_vec.push_back(getSiteCoords(site_index));
 				}
 			}
+			return coords_vec;
 		}
-		if ((int)coords_vec.size() == 1) {
-			return coords_vec[0];
+		vector<int64_t> unoccupied_indices;
+		for (int64_t n = 0; n < (int64_t)site_ptrs.size(); n++) {
+			if (!site_ptrs[n]->isOccupied()) {
+				unoccupied_indices.push_back(n);
+			}
 		}
-		else if ((int)coords_vec.size() > 1) {
-			uniform_int_distribution<> dist(0, (int)coords_vec.size() - 1);
-			return coords_vec[dist(*gen_ptr)];
+		for (int64_t n = 0; n < num_sites; n++) {
+			swap(unoccupied_indices[n], unoccupied_indices[n + (int64_t)BoundedSampler64::generate(*gen_ptr, (uint64_t)((int64_t)unoccupied_indices.size() - n))]);
+			coords_vec.push_back(getSiteCoords(unoccupied_indices[n]));
 		}
-		else {
-			coords_f = { -1,-1,-1 };
-			return coords_f;
+		return coords_vec;
+	}
+
+	void Lattice::checkDenseStorage() const {
+		if (Enable_sparse_storage) {
+			cout << "Error! The site vector cannot be accessed when the lattice is using sparse storage." << endl;
+			throw logic_error("The site vector cannot be accessed when the lattice is using sparse storage.");
+		}
+	}
+
+	void Lattice::checkPeriodicity(const bool periodic_x, const bool periodic_y, const bool periodic_z) const {
+		if (periodic_x != Enable_periodic_x || periodic_y != Enable_periodic_y || periodic_z != Enable_periodic_z) {
+			cout << "Error! The requested periodic boundary conditions do not match those of the lattice." << endl;
+			throw logic_error("The requested periodic boundary conditions do not match those of the lattice.");
+		}
+	}
+
+	void Lattice::checkSiteEnergies() const {
+		if (!Enable_site_energies) {
+			cout << "Error! The site energies are not enabled." << endl;
+			throw logic_error("The site energies are not enabled.");
+		}
+	}
+
+	void Lattice::checkSiteIndex(const int64_t site_index) const {
+		if (site_index < 0 || site_index >= getNumSites()) {
+			cout << "Error! Input site index is not located in the lattice." << endl;
+			throw out_of_range("Input site index is not located in the lattice.");
 		}
 	}
 
 	void Lattice::clearOccupancy(const Coords& coords) {
-		site_ptrs[getSiteIndex(coords)]->clearOccupancy();
+		clearOccupancy(getSiteIndex(coords));
+	}
+
+	void Lattice::createExponentialSiteEnergies(const double mode, const double urbach_energy) {
+		checkSiteEnergies();
+		createExponentialDOSVector(site_energies, mode, urbach_energy, *gen_ptr);
+	}
+
+	void Lattice::createExponentialSiteEnergies(const double mode, const double urbach_energy, const uint64_t seed, const int num_threads) {
+		checkSiteEnergies();
+		createExponentialDOSVector(site_energies, mode, urbach_energy, seed, num_threads);
 	}
 
-	Coords Lattice::generateRandomCoords() {
-		Coords coords;
-		coords.x = generateRandomX();
-		coords.y = generateRandomY();
-		coords.z = generateRandomZ();
-		return coords;
+	void Lattice::createGaussianSiteEnergies(const double mean, const double stdev) {
+		checkSiteEnergies();
+		createGaussianDOSVector(site_energies, mean, stdev, *gen_ptr);
 	}
 
-	int Lattice::generateRandomX() {
-		uniform_int_distribution<int> distx(0, Length - 1);
-		return distx(*gen_ptr);
+	void Lattice::createGaussianSiteEnergies(const double mean, const double stdev, const uint64_t seed, const int num_threads) {
+		checkSiteEnergies();
+		createGaussianDOSVector(site_energies, mean, stdev, seed, num_threads);
 	}
 
-	int Lattice::generateRandomY() {
-		uniform_int_distribution<int> disty(0, Width - 1);
-		return disty(*gen_ptr);
+	int Lattice::findNeighborIndices(const int64_t site_index, int64_t* neighbor_indices) {
+		Coords coords = getSiteCoordsUnchecked(site_index);
+		int64_t stride_y = Height;
+		int64_t stride_x = (int64_t)Width*Height;
+		int num_neighbors = 0;
+		// Neighbors across periodic boundaries are skipped when they would be the site itself or, in a periodic direction of
+		// size two, the same site as the neighbor in the other direction
+		if (coords.x > 0) {
+			neighbor_indices[num_neighbors++] = site_index - stride_x;
+		}
+		else if (Enable_periodic_x && Length > 2) {
+			neighbor_indices[num_neighbors++] = site_index + (Length - 1)*stride_x;
+		}
+		if (coords.x < Length - 1) {
+			neighbor_indices[num_neighbors++] = site_index + stride_x;
+		}
+		else if (Enable_periodic_x && Length > 2) {
+			neighbor_indices[num_neighbors++] = site_index - (Length - 1)*stride_x;
+		}
+		if (coords.y > 0) {
+			neighbor_indices[num_neighbors++] = site_index - stride_y;
+		}
+		else if (Enable_periodic_y && Width > 2) {
+			neighbor_indices[num_neighbors++] = site_index + (Width - 1)*stride_y;
+		}
+		if (coords.y < Width - 1) {
+			neighbor_indices[num_neighbors++] = site_index + stride_y;
+		}
+		else if (Enable_periodic_y && Width > 2) {
+			neighbor_indices[num_neighbors++] = site_index - (Width - 1)*stride_y;
+		}
+		if (coords.z > 0) {
+			neighbor_indices[num_neighbors++] = site_index - 1;
+		}
+		else if (Enable_periodic_z && Height > 2) {
+			neighbor_indices[num_neighbors++] = site_index + (Height - 1);
+		}
+		if (coords.z < Height - 1) {
+			neighbor_indices[num_neighbors++] = site_index + 1;
+		}
+		else if (Enable_periodic_z && Height > 2) {
+			neighbor_indices[num_neighbors++] = site_index - (Height - 1);
+		}
+		return num_neighbors;
+	}
+
+	const DisplacementEntry* Lattice::lookupDisplacement(const Coords& coords_start, const Coords& coords_dest) const {
+		if (Displacement_cutoff == 0) {
+			cout << "Error! The displacement table has not been constructed." << endl;
+			throw logic_error("The displacement table has not been constructed.");
+		}
+		int dx = image_delta_x[coords_dest.x - coords_start.x + Length - 1];
+		int dy = image_delta_y[coords_dest.y - coords_start.y + Width - 1];
+		int dz = image_delta_z[coords_dest.z - coords_start.z + Height - 1];
+		if (abs(dx) > Displacement_cutoff || abs(dy) > Displacement_cutoff || abs(dz) > Displacement_cutoff) {
+			return nullptr;
+		}
+		int table_width = 2 * Displacement_cutoff + 1;
+		return &displacement_table[((dx + Displacement_cutoff)*table_width + dy + Displacement_cutoff)*table_width + dz + Displacement_cutoff];
 	}
 
-	int Lattice::generateRandomZ() {
-		uniform_int_distribution<int> distz(0, Height - 1);
-		return distz(*gen_ptr);
+	const vector<HopDisplacement>& Lattice::getHopDisplacements() const {
+		return hop_displacements;
+	}
+
+	Object* Lattice::getObjectPtr(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			const SiteHashMap::Entry* entry_ptr = site_map.find(site_index);
+			return (entry_ptr != nullptr) ? entry_ptr->object_ptr : nullptr;
+		}
+		return site_ptrs[site_index]->getObjectPtr();
 	}
 
 	int Lattice::getHeight() const {
@@ -229,26 +524,91 @@ namespace KMC_Lattice {
 		return Length;
 	}
 
-	long int Lattice::getNumSites() const {
-		return (int)site_ptrs.size();
+	int64_t Lattice::getNumSites() const {
+		return (int64_t)Length*Width*Height;
+	}
+
+	int Lattice::getNumNeighborsOfSpecies(const int64_t site_index, const uint8_t species) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		int64_t neighbor_indices[6];
+		int num_neighbors = findNeighborIndices(site_index, neighbor_indices);
+		int count = 0;
+		for (int n = 0; n < num_neighbors; n++) {
+			count += (site_species[neighbor_indices[n]] == species) ? 1 : 0;
+		}
+		return count;
+	}
+
+	int Lattice::getNumNeighborsOfType(const int64_t site_index, const uint8_t type) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		int64_t neighbor_indices[6];
+		int num_neighbors = findNeighborIndices(site_index, neighbor_indices);
+		int count = 0;
+		for (int n = 0; n < num_neighbors; n++) {
+			count += (site_types[neighbor_indices[n]] == type) ? 1 : 0;
+		}
+		return count;
 	}
 
-	Coords Lattice::getSiteCoords(long int site_index) {
-		if (site_index < 0 || site_index >= Length * Width*Height) {
+	int Lattice::getNumOccupiedNeighbors(const int64_t site_index) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_neighbor_counts) {
+			return neighbor_counts[site_index];
+		}
+		int64_t neighbor_indices[6];
+		int num_neighbors = findNeighborIndices(site_index, neighbor_indices);
+		int count = 0;
+		for (int n = 0; n < num_neighbors; n++) {
+			if (isOccupied(neighbor_indices[n])) {
+				count++;
+			}
+		}
+		return count;
+	}
+
+	int Lattice::getNumOccupiedNeighbors(const Coords& coords) {
+		return getNumOccupiedNeighbors(getSiteIndex(coords));
+	}
+
+	int64_t Lattice::getNumUnoccupiedSites() const {
+		if (Enable_free_site_index) {
+			return (int64_t)free_site_indices.size();
+		}
+		if (Enable_sparse_storage) {
+			int64_t num_occupied = (int64_t)count_if(site_map.getSlots().begin(), site_map.getSlots().end(), [](const SiteHashMap::Entry& entry) {
+				return entry.occupied;
+			});
+			return getNumSites() - num_occupied;
+		}
+		return (int64_t)count_if(site_ptrs.begin(), site_ptrs.end(), [](Site* site_ptr) {
+			return !site_ptr->isOccupied();
+		});
+	}
+
+	Coords Lattice::getSiteCoords(int64_t site_index) {
+		if (site_index < 0 || site_index >= getNumSites()) {
 			cout << "Error! Input site index is not located in the lattice." << endl;
 			throw out_of_range("Input site index is not located in the lattice.");
 		}
-		Coords coords;
-		coords.x = site_index / (Width*Height);
-		int remainder = site_index % (Width*Height);
-		coords.y = remainder / Height;
-		coords.z = remainder % Height;
-		return coords;
+		return getSiteCoordsUnchecked(site_index);
 	}
 
-	long int Lattice::getSiteIndex(const Coords& coords) const {
+	const vector<float>& Lattice::getSiteEnergies() const {
+		return site_energies;
+	}
+
+	int64_t Lattice::getSiteIndex(const Coords& coords) const {
 		if (coords.x >= 0 && coords.x < Length && coords.y >= 0 && coords.y < Width && coords.z >= 0 && coords.z < Height) {
-			return coords.x*Width*Height + coords.y*Height + coords.z;
+			if (Power_of_two) {
+				return ((int64_t)coords.x << Index_shift_x) | ((int64_t)coords.y << Index_shift_y) | coords.z;
+			}
+			return ((int64_t)coords.x*Width + coords.y)*Height + coords.z;
 		}
 		else {
 			cout << "Error! Input coordinates are not located in the lattice." << endl;
@@ -257,11 +617,33 @@ namespace KMC_Lattice {
 	}
 
 	vector<Site*>::iterator Lattice::getSiteIt(const Coords& coords) {
+		checkDenseStorage();
 		auto site_it = site_ptrs.begin();
 		advance(site_it, getSiteIndex(coords));
 		return site_it;
 	}
 
+	Site* Lattice::getSitePtr(const int64_t site_index) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (!Enable_sparse_storage) {
+			return site_ptrs[site_index];
+		}
+		SiteHashMap::Entry& entry = site_map.insert(site_index);
+		if (entry.site_ptr == nullptr) {
+			sparse_site_ptrs.push_back(shared_ptr<Site>(site_factory()));
+			entry.site_ptr = sparse_site_ptrs.back().get();
+			if (entry.object_ptr != nullptr) {
+				entry.site_ptr->setObjectPtr(entry.object_ptr);
+			}
+			else if (entry.occupied) {
+				entry.site_ptr->setOccupied();
+			}
+		}
+		return entry.site_ptr;
+	}
+
 	double Lattice::getUnitSize() const {
 		return Unit_size;
 	}
@@ -271,11 +653,35 @@ namespace KMC_Lattice {
 	}
 
 	double Lattice::getVolume() const {
-		return ((Length*Width*Height*1e-7*Unit_size)*1e-7*Unit_size)*1e-7*Unit_size;
+		return (((double)getNumSites()*1e-7*Unit_size)*1e-7*Unit_size)*1e-7*Unit_size;
+	}
+
+	bool Lattice::isFreeSiteIndexEnabled() const {
+		return Enable_free_site_index;
+	}
+
+	bool Lattice::isNeighborCountsEnabled() const {
+		return Enable_neighbor_counts;
 	}
 
 	bool Lattice::isOccupied(const Coords& coords) const {
-		return site_ptrs[getSiteIndex(coords)]->isOccupied();
+		return isOccupied(getSiteIndex(coords));
+	}
+
+	bool Lattice::isPowerOfTwo() const {
+		return Power_of_two;
+	}
+
+	bool Lattice::isSparse() const {
+		return Enable_sparse_storage;
+	}
+
+	bool Lattice::isSiteEnergiesEnabled() const {
+		return Enable_site_energies;
+	}
+
+	bool Lattice::isSiteStatesEnabled() const {
+		return Enable_site_states;
 	}
 
 	bool Lattice::isXPeriodic() const {
@@ -291,6 +697,19 @@ namespace KMC_Lattice {
 	}
 
 	void Lattice::outputLatticeOccupancy() const {
+		if (Enable_sparse_storage) {
+			vector<int64_t> occupied_indices;
+			for (auto const &item : site_map.getSlots()) {
+				if (item.site_index >= 0 && item.occupied) {
+					occupied_indices.push_back(item.site_index);
+				}
+			}
+			sort(occupied_indices.begin(), occupied_indices.end());
+			for (auto const &item : occupied_indices) {
+				cout << "Site " << item << " is occupied." << endl;
+			}
+			return;
+		}
 		for (auto site_it = site_ptrs.begin(); site_it != site_ptrs.end(); ++site_it) {
 			if ((*site_it)->isOccupied()) {
 				cout << "Site " << distance(site_ptrs.begin(), site_it) << " is occupied." << endl;
@@ -299,16 +718,175 @@ namespace KMC_Lattice {
 	}
 
 	void Lattice::setOccupied(const Coords& coords) {
-		site_ptrs[getSiteIndex(coords)]->setOccupied();
+		setOccupied(getSiteIndex(coords));
+	}
+
+	void Lattice::updateNeighborCounts(const int64_t site_index, const int change) {
+		int64_t neighbor_indices[6];
+		int num_neighbors = findNeighborIndices(site_index, neighbor_indices);
+		for (int n = 0; n < num_neighbors; n++) {
+			neighbor_counts[neighbor_indices[n]] = (uint8_t)(neighbor_counts[neighbor_indices[n]] + change);
+		}
+	}
+
+	void Lattice::setupDisplacementTable(const int cutoff) {
+		if (cutoff < 1) {
+			cout << "Error! The displacement table cutoff must be at least one lattice unit." << endl;
+			throw invalid_argument("The displacement table cutoff must be at least one lattice unit.");
+		}
+		// Minimum image tables for every raw coordinate difference in the range from -(size-1) to size-1
+		auto build_image_tables = [](const int size, const bool periodic, vector<int>& deltas, vector<int>& deltas_sq) {
+			deltas.resize(2 * size - 1);
+			deltas_sq.resize(2 * size - 1);
+			for (int delta = -(size - 1); delta <= size - 1; delta++) {
+				int image_delta = delta;
+				if (periodic && 2 * delta > size) {
+					image_delta -= size;
+				}
+				else if (periodic && 2 * delta < -size) {
+					image_delta += size;
+				}
+				deltas[delta + size - 1] = image_delta;
+				deltas_sq[delta + size - 1] = image_delta * image_delta;
+			}
+		};
+		build_image_tables(Length, Enable_periodic_x, image_delta_x, image_delta_sq_x);
+		build_image_tables(Width, Enable_periodic_y, image_delta_y, image_delta_sq_y);
+		build_image_tables(Height, Enable_periodic_z, image_delta_z, image_delta_sq_z);
+		// Table of the displacement properties for all vectors with components up to the cutoff
+		Displacement_cutoff = cutoff;
+		int table_width = 2 * cutoff + 1;
+		displacement_table.resize(table_width*table_width*table_width);
+		for (int i = -cutoff; i <= cutoff; i++) {
+			for (int j = -cutoff; j <= cutoff; j++) {
+				for (int k = -cutoff; k <= cutoff; k++) {
+					DisplacementEntry& entry = displacement_table[((i + cutoff)*table_width + j + cutoff)*table_width + k + cutoff];
+					entry.distance_sq = i * i + j * j + k * k;
+					entry.inverse_distance = (entry.distance_sq > 0) ? (float)(1.0 / sqrt((double)entry.distance_sq)) : 0.0f;
+					entry.unit_x = i * entry.inverse_distance;
+					entry.unit_y = j * entry.inverse_distance;
+					entry.unit_z = k * entry.inverse_distance;
+				}
+			}
+		}
+	}
+
+	void Lattice::setupHopDisplacements(const double cutoff_radius, const double localization) {
+		if (cutoff_radius < Unit_size) {
+			cout << "Error! The hop cutoff radius must be at least one lattice unit." << endl;
+			throw invalid_argument("The hop cutoff radius must be at least one lattice unit.");
+		}
+		if (localization < 0) {
+			cout << "Error! The localization parameter must not be negative." << endl;
+			throw invalid_argument("The localization parameter must not be negative.");
+		}
+		// A small tolerance keeps displacements exactly at the cutoff radius despite rounding errors, such as with a cutoff of sqrt(3)
+		int range = (int)floor(cutoff_radius / Unit_size + 1e-9);
+		int cutoff_sq_lat = (int)floor((cutoff_radius / Unit_size)*(cutoff_radius / Unit_size) + 1e-9);
+		// Limit the displacements in periodic directions to half the lattice size so that each destination is unique, where the
+		// image at exactly half of an even lattice size is only included in the positive direction
+		int range_x = min(range, Enable_periodic_x ? Length / 2 : Length - 1);
+		int range_y = min(range, Enable_periodic_y ? Width / 2 : Width - 1);
+		int range_z = min(range, Enable_periodic_z ? Height / 2 : Height - 1);
+		int start_x = (Enable_periodic_x && Length % 2 == 0 && range_x == Length / 2) ? -range_x + 1 : -range_x;
+		int start_y = (Enable_periodic_y && Width % 2 == 0 && range_y == Width / 2) ? -range_y + 1 : -range_y;
+		int start_z = (Enable_periodic_z && Height % 2 == 0 && range_z == Height / 2) ? -range_z + 1 : -range_z;
+		hop_displacements.clear();
+		for (int i = start_x; i <= range_x; i++) {
+			for (int j = start_y; j <= range_y; j++) {
+				for (int k = start_z; k <= range_z; k++) {
+					int distance_sq = i * i + j * j + k * k;
+					if (distance_sq == 0 || distance_sq > cutoff_sq_lat) {
+						continue;
+					}
+					HopDisplacement displacement;
+					displacement.i = i;
+					displacement.j = j;
+					displacement.k = k;
+					displacement.distance_sq = distance_sq;
+					displacement.prefactor = exp(-2.0*localization*Unit_size*sqrt((double)distance_sq));
+					hop_displacements.push_back(displacement);
+				}
+			}
+		}
+		stable_sort(hop_displacements.begin(), hop_displacements.end(), [](const HopDisplacement& a, const HopDisplacement& b) {
+			return a.distance_sq < b.distance_sq;
+		});
+	}
+
+	bool Lattice::setSiteEnergies(const vector<float>& energies) {
+		if (!Enable_site_energies) {
+			cout << "Error setting the site energies! The site energies are not enabled." << endl;
+			return false;
+		}
+		if ((int64_t)energies.size() != getNumSites()) {
+			cout << "Error setting the site energies! The number of site energies in the input vector does not equal the number of lattice sites." << endl;
+			return false;
+		}
+		site_energies = energies;
+		return true;
+	}
+
+	bool Lattice::setSiteTypes(const vector<uint8_t>& types) {
+		if (!Enable_site_states) {
+			cout << "Error setting the site types! The site states are not enabled." << endl;
+			return false;
+		}
+		if ((int64_t)types.size() != getNumSites()) {
+			cout << "Error setting the site types! The number of site types in the input vector does not equal the number of lattice sites." << endl;
+			return false;
+		}
+		site_types = types;
+		return true;
+	}
+
+	bool Lattice::setSiteTypes(const vector<int64_t>& site_indices, const uint8_t type) {
+		if (!Enable_site_states) {
+			cout << "Error setting the site types! The site states are not enabled." << endl;
+			return false;
+		}
+		if (any_of(site_indices.begin(), site_indices.end(), [this](const int64_t site_index) { return site_index < 0 || site_index >= getNumSites(); })) {
+			cout << "Error setting the site types! One or more input site indices are not located in the lattice." << endl;
+			return false;
+		}
+		for (auto const &item : site_indices) {
+			site_types[item] = type;
+		}
+		return true;
+	}
+
+	void Lattice::setSiteFactory(const function<Site*()>& factory) {
+		site_factory = factory;
 	}
 
 	bool Lattice::setSitePointers(const vector<Site*>& input_ptrs) {
-		if ((int)input_ptrs.size() != getNumSites()) {
+		if (Enable_sparse_storage) {
+			cout << "Error setting the lattice site pointers! Site pointers cannot be set when the lattice is using sparse storage." << endl;
+			return false;
+		}
+		if ((int64_t)input_ptrs.size() != getNumSites()) {
 			cout << "Error setting the lattice site pointers! The number of sites in the input vector do not equal the expected number of lattice sites." << endl;
 			return false;
 		}
 		else {
 			site_ptrs = input_ptrs;
+			if (Enable_neighbor_counts) {
+				neighbor_counts.assign(site_ptrs.size(), 0);
+				for (int64_t n = 0; n < (int64_t)site_ptrs.size(); n++) {
+					if (site_ptrs[n]->isOccupied()) {
+						updateNeighborCounts(n, 1);
+					}
+				}
+			}
+			if (Enable_free_site_index) {
+				free_site_indices.clear();
+				free_site_positions.assign(site_ptrs.size(), -1);
+				for (int64_t n = 0; n < (int64_t)site_ptrs.size(); n++) {
+					if (!site_ptrs[n]->isOccupied()) {
+						addFreeSite(n);
+					}
+				}
+			}
 			return true;
 		}
 	}
@@ -9,14 +9,49 @@
 #include "Utils.h"
 #include "Parameters_Lattice.h"
 #include "Site.h"
+#include "SiteHashMap.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 
 namespace KMC_Lattice {
 
+	//! \brief This struct contains a precomputed hop displacement vector and its distance-dependent properties.
+	struct HopDisplacement {
+		//! The displacement in the x-direction.
+		int i;
+		//! The displacement in the y-direction.
+		int j;
+		//! The displacement in the z-direction.
+		int k;
+		//! The length of the displacement vector in squared lattice units.
+		int distance_sq;
+		//! The distance-dependent tunneling prefactor, exp(-2*gamma*r), where gamma is the localization parameter and r is the hop distance.
+		double prefactor;
+	};
+
+	//! \brief This struct contains the precomputed properties of a minimum image displacement vector between two lattice sites.
+	struct DisplacementEntry {
+		//! The length of the displacement vector in squared lattice units.
+		int distance_sq;
+		//! The inverse of the length of the displacement vector in inverse lattice units, which is zero for the zero vector.
+		float inverse_distance;
+		//! The x-component of the unit vector in the displacement direction.
+		float unit_x;
+		//! The y-component of the unit vector in the displacement direction.
+		float unit_y;
+		//! The z-component of the unit vector in the displacement direction.
+		float unit_z;
+	};
+
 	//! \brief This class contains the properties of a three-dimensional lattice and the functions needed to interact with it.
 	//! \details The class makes use of the Parameters_Lattice struct to load the necessary input parameters, the Coords struct
 	//! to record the Cartesian coordinates of each lattice site, and the Site class to assign properties to each site.
+	//! By default, the lattice stores a pointer to a Site object for every lattice site. In sparse storage mode, only the occupied
+	//! sites are stored in a SiteHashMap, and Site objects are only created when they are requested using the getSitePtr function.
 	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
 	//! \author Michael C. Heiber
 	//! \date 2017-2019
@@ -29,8 +64,8 @@ namespace KMC_Lattice {
 		//! \brief Initializes the Lattice object using the provided Parameters_Lattice input parameter struct.
 		//! \param params is a Parameters_Lattice struct that contains all of the required
 		//! parameters to initialize the Lattice object. 
-		//! \param generator_ptr is a pointer to a Mersenne twister number generator.
-		void init(const Parameters_Lattice& params, std::mt19937_64* generator_ptr);
+		//! \param generator_ptr is a pointer to the random number generator engine.
+		void init(const Parameters_Lattice& params, RandomEngine* generator_ptr);
 
 		//! \brief Calculates the destination coordinates when given the starting coordinates and the displacement vector (i,j,k).
 		//! \details When the starting coordinates are near one or more of the lattice boundaries and periodic boundary conditions are enabled,
@@ -43,6 +78,19 @@ namespace KMC_Lattice {
 		//! \param coords_dest is Coords struct that indicates the output destination coordinates.
 		void calculateDestinationCoords(const Coords& coords_initial, const int i, const int j, const int k, Coords& coords_dest) const;
 
+		//! \brief Calculates the destination coordinates using periodic boundary conditions that are fixed at compile time.
+		//! \details This template version of calculateDestinationCoords replaces the runtime periodic boundary checks with
+		//! branch-free arithmetic, and the runtime version calls the template instance that matches the lattice. The template
+		//! parameters must match the periodic boundary settings of the lattice, which is checked when the library is compiled
+		//! with KMC_LATTICE_DEBUG defined.
+		//! \param coords_initial is the Coords struct that designates the starting coordinates.
+		//! \param i is the displacement in the x-direction.
+		//! \param j is the displacement in the y-direction.
+		//! \param k is the displacement in the z-direction.
+		//! \param coords_dest is Coords struct that indicates the output destination coordinates.
+		template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+		void calculateDestinationCoords(const Coords& coords_initial, const int i, const int j, const int k, Coords& coords_dest) const;
+
 		//! \brief Calculates a coordinate adjustment factor if the x-direction periodic boundary is crossed.
 		//! \param x is the starting x coordinate.
 		//! \param i is the displacement in the x-direction.
@@ -91,12 +139,55 @@ namespace KMC_Lattice {
 		//! \return 0 if the z periodic boundary is not enabled or if the z periodic boundary is not crossed.
 		int calculateDZ(const Coords& coords_initial, const Coords& coords_dest) const;
 
+		//! \brief Calculates the periodic image shift of a move between a pair of coordinates in all three directions at once.
+		//! \details The components of the image shift are the negatives of the values returned by the calculateDX, calculateDY,
+		//! and calculateDZ functions, so that the image shift can be directly added to the periodic boundary crossing counters of an Object.
+		//! \param coords_initial is the Coords struct that represents the starting coordinates.
+		//! \param coords_dest is the Coords struct that represents the destination coordinates.
+		//! \return a Coords struct where each component is -size if the periodic boundary is crossed in the positive direction,
+		//! size if it is crossed in the negative direction, and 0 otherwise.
+		Coords calculateImageShift(const Coords& coords_initial, const Coords& coords_dest) const;
+
 		//! \brief Calculates the shortest distance between a pair of coordinates in squared lattice units.
+		//! \details When the displacement table has been constructed using the setupDisplacementTable function, the distance is
+		//! calculated from three indexed loads of the squared minimum image separations instead of using comparisons and multiplications.
 		//! \param coords_start is the Coords struct that represents the starting coordinates.
 		//! \param coords_dest is the Coords struct that represents the destination coordinates.
 		//! \return The distance between the two sets of coordinates in squared lattice units.
 		int calculateLatticeDistanceSquared(const Coords& coords_start, const Coords& coords_dest) const;
 
+		//! \brief Calculates the shortest distance between a pair of coordinates using periodic boundary conditions that are fixed at compile time.
+		//! \details This template version of calculateLatticeDistanceSquared calculates the minimum image separations with branch-free
+		//! arithmetic, so that loops over many coordinate pairs can be vectorized by the compiler. It does not use the displacement table.
+		//! The template parameters must match the periodic boundary settings of the lattice, which is checked when the library is compiled
+		//! with KMC_LATTICE_DEBUG defined.
+		//! \param coords_start is the Coords struct that represents the starting coordinates.
+		//! \param coords_dest is the Coords struct that represents the destination coordinates.
+		//! \return The distance between the two sets of coordinates in squared lattice units.
+		template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+		int calculateLatticeDistanceSquared(const Coords& coords_start, const Coords& coords_dest) const;
+
+		//! \brief Calculates the shortest distances between the starting coordinates and a batch of destination coordinates in squared lattice units.
+		//! \details The destination coordinates are input in structure-of-arrays format. The calculation uses AVX2 or SSE4.1 vector
+		//! instructions when the library is compiled with them enabled (e.g. using -mavx2 or -march=native) and a branch-free scalar loop otherwise.
+		//! \param coords_start is the Coords struct that represents the starting coordinates.
+		//! \param x is the array of destination x coordinates.
+		//! \param y is the array of destination y coordinates.
+		//! \param z is the array of destination z coordinates.
+		//! \param num_coords is the number of destination coordinates in each array.
+		//! \param distances_sq is the output array where the distances in squared lattice units will be placed, which must be preallocated to size num_coords.
+		void calculateLatticeDistanceSquared(const Coords& coords_start, const int* x, const int* y, const int* z, const int num_coords, int* distances_sq) const;
+
+		//! \brief Calculates the site energy differences, E_dest - E_start, between the starting site and every hop destination.
+		//! \details The site energies must be enabled and the hop displacements must be constructed using the setupHopDisplacements function.
+		//! The output arrays are ordered in the same way as the getHopDisplacements vector, so that the tunneling prefactors can be applied
+		//! using the same index. Destinations that cross a non-periodic boundary have a site index of -1 and an energy difference of
+		//! positive infinity, so that any Boltzmann factor calculated from them is zero.
+		//! \param coords is the Coords struct that designates the starting coordinates.
+		//! \param dest_indices is the output array of destination site indices, which must be preallocated to the number of hop displacements.
+		//! \param energy_diffs is the output array of energy differences, which must be preallocated to the number of hop displacements.
+		void calculateHopEnergyDifferences(const Coords& coords, int64_t* dest_indices, float* energy_diffs) const;
+
 		//! \brief Checks to see if a generic move operation from the designated initial coordinates to a destination
 		//! position specified by the displacement vector (i,j,k) is possible.
 		//! \details The main use of this function is used to check if a proposed move event crosses a non-periodic boundary.
@@ -108,36 +199,161 @@ namespace KMC_Lattice {
 		//! \return false if a move event is not possible.
 		bool checkMoveValidity(const Coords& coords_initial, const int i, const int j, const int k) const;
 
+		//! \brief Checks to see if a move from the designated initial coordinates by the displacement vector (i,j,k) is possible
+		//! using periodic boundary conditions that are fixed at compile time.
+		//! \details The boundary checks for the periodic directions are removed at compile time. The template parameters must match
+		//! the periodic boundary settings of the lattice, which is checked when the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param coords_initial is the Coords struct that represents the starting coordinates.
+		//! \param i is the displacement in the x-direction.
+		//! \param j is the displacement in the y-direction.
+		//! \param k is the displacement in the z-direction.
+		//! \return true if a move event is possible.
+		//! \return false if a move event is not possible.
+		template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+		bool checkMoveValidity(const Coords& coords_initial, const int i, const int j, const int k) const;
+
 		//! \brief Randomly selects a valid, unoccupied nearest neighbor site
-		//! \details Will choose a site across a periodic boundary if periodic boundaries are enabled.
+		//! \details Will choose a site across a periodic boundary if periodic boundaries are enabled. The candidate sites are stored
+		//! in a fixed size array, so the function does not allocate memory. The periodic boundary settings are checked once per call
+		//! to select the matching compile-time version of the function.
+		//! \param coords_i is the Coords struct that designates the starting coordinates.
+		//! \return a Coords struct that represents the selected unoccupied nearest neighbor site.
+		//! \return {-1,-1,-1} if there is no valid unoccupied neighbor
+		Coords chooseRandomUnoccupiedNeighbor(const Coords& coords_i);
+
+		//! \brief Randomly selects a valid, unoccupied nearest neighbor site using periodic boundary conditions that are fixed at compile time.
+		//! \details The template parameters must match the periodic boundary settings of the lattice, which is checked when the library
+		//! is compiled with KMC_LATTICE_DEBUG defined.
 		//! \param coords_i is the Coords struct that designates the starting coordinates.
 		//! \return a Coords struct that represents the selected unoccupied nearest neighbor site.
 		//! \return {-1,-1,-1} if there is no valid unoccupied neighbor
+		template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
 		Coords chooseRandomUnoccupiedNeighbor(const Coords& coords_i);
 
+		//! \brief Randomly selects a valid, unoccupied nearest neighbor site of the site with the input site index.
+		//! \details Will choose a site across a periodic boundary if periodic boundaries are enabled. The neighbors are found
+		//! using site index strides, so the destination coordinates do not need to be calculated.
+		//! \param site_index is the vector index of the starting site.
+		//! \return the vector index of the selected unoccupied nearest neighbor site.
+		//! \return -1 if there is no valid unoccupied neighbor.
+		int64_t chooseRandomUnoccupiedNeighbor(const int64_t site_index);
+
+		//! \brief Randomly selects an unoccupied site from anywhere in the lattice.
+		//! \details When the free site index is enabled, the site is chosen in constant time regardless of the lattice occupancy.
+		//! Otherwise, random sites are tested until an unoccupied site is found, and after a limited number of attempts,
+		//! the unoccupied sites are found by scanning the entire lattice.
+		//! \return a Coords struct that represents the selected unoccupied site.
+		//! \return {-1,-1,-1} if there are no unoccupied sites.
+		Coords chooseRandomUnoccupiedSite();
+
+		//! \brief Randomly selects a number of distinct unoccupied sites from anywhere in the lattice.
+		//! \details When the free site index is enabled, the sites are chosen in time proportional to the number of requested sites
+		//! using a partial Fisher-Yates shuffle of the index. Otherwise, the lattice is scanned to find the unoccupied sites.
+		//! The selected sites are not set to the occupied state.
+		//! \param num_sites is the number of unoccupied sites to be chosen.
+		//! \return a vector of Coords structs that represent the selected unoccupied sites.
+		std::vector<Coords> chooseRandomUnoccupiedSites(const int num_sites);
+
 		//! \brief Clears the occupancy of the site located at the specified coordinates.
 		//! \param coords is the Coords struct that represents the coordinates of the site to be cleared.
 		void clearOccupancy(const Coords& coords);
 
+		//! \brief Clears the occupancy of the site with the input site index.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the site to be cleared.
+		void clearOccupancy(const int64_t site_index);
+
+		//! \brief Calls the input function for every valid destination site that is within the hop cutoff radius of the input coordinates.
+		//! \details The hop displacements must first be constructed using the setupHopDisplacements function. Destinations that cross
+		//! a non-periodic boundary are skipped, and destinations that cross a periodic boundary are wrapped back into the lattice.
+		//! The destinations are visited in order of increasing distance.
+		//! \param coords is the Coords struct that designates the starting coordinates.
+		//! \param func is the function or lambda to be called as func(const HopDisplacement& displacement, int64_t site_index), where
+		//! site_index is the vector index of the destination site.
+		template<typename Function>
+		void forEachHopDestination(const Coords& coords, Function func) const;
+
+		//! \brief Calls the input function for every site index of the lattice using multiple threads.
+		//! \details The site index range is divided into contiguous blocks, one for each thread. The function must only modify data
+		//! that belongs to the input site, such as the attributes of a derived Site object, so that no synchronization is needed.
+		//! Random site attributes should be drawn from a counter-based generator such as Philox4x32 using the site index as the counter,
+		//! so that the results do not depend on the number of threads.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		//! \param func is the function or lambda to be called as func(int64_t site_index).
+		template<typename Function>
+		void forEachSiteParallel(const int num_threads, Function func) const;
+
+		//! \brief Gets the pointer to the Object that occupies the site with the input site index.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return the pointer to the occupying Object or nullptr if no Object has been assigned to the site.
+		Object* getObjectPtr(const int64_t site_index) const;
+
+		//! \brief Fills the site energy array with energies drawn from an exponential tail density of states.
+		//! \details The site energies must be enabled. The energies are generated using the createExponentialDOSVector function.
+		//! \param mode is the value of the peak of the distribution.
+		//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
+		void createExponentialSiteEnergies(const double mode, const double urbach_energy);
+
+		//! \brief Fills the site energy array with energies drawn from an exponential tail density of states using multiple threads.
+		//! \details The site energies must be enabled. The energies are generated using the counter-based createExponentialDOSVector function,
+		//! so they only depend on the seed and not on the number of threads.
+		//! \param mode is the value of the peak of the distribution.
+		//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
+		//! \param seed is the seed of the counter-based random number generator.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		void createExponentialSiteEnergies(const double mode, const double urbach_energy, const uint64_t seed, const int num_threads);
+
+		//! \brief Fills the site energy array with energies drawn from a Gaussian density of states.
+		//! \details The site energies must be enabled. The energies are generated using the createGaussianDOSVector function.
+		//! \param mean is the position of the peak and center of the distribution.
+		//! \param stdev is the standard deviation of the distribution.
+		void createGaussianSiteEnergies(const double mean, const double stdev);
+
+		//! \brief Fills the site energy array with energies drawn from a Gaussian density of states using multiple threads.
+		//! \details The site energies must be enabled. The energies are generated using the counter-based createGaussianDOSVector function,
+		//! so they only depend on the seed and not on the number of threads.
+		//! \param mean is the position of the peak and center of the distribution.
+		//! \param stdev is the standard deviation of the distribution.
+		//! \param seed is the seed of the counter-based random number generator.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		void createGaussianSiteEnergies(const double mean, const double stdev, const uint64_t seed, const int num_threads);
+
+		//! \brief Gets the precomputed minimum image displacement properties between a pair of coordinates.
+		//! \details The displacement table must first be constructed using the setupDisplacementTable function.
+		//! \param coords_start is the Coords struct that represents the starting coordinates.
+		//! \param coords_dest is the Coords struct that represents the destination coordinates.
+		//! \return a pointer to the DisplacementEntry struct for the minimum image displacement from the starting to the destination coordinates.
+		//! \return nullptr if any component of the minimum image displacement is larger than the table cutoff.
+		const DisplacementEntry* lookupDisplacement(const Coords& coords_start, const Coords& coords_dest) const;
+
 		//! \brief Generates the coordinates for a randomly selected site in the lattice.
 		//! \return A Coords struct containing the coordinates of a randomly selected site from the lattice.
 		Coords generateRandomCoords();
 
 		//! \brief Generates a random x coordinate that lies within the x-dimension size of the lattice.
+		//! \details The coordinate is generated with a bit mask in the power of two mode and otherwise with a bounded sampler
+		//! that is set up when the lattice is initialized, so no divisions are needed.
 		//! \return
 		//! A randomly selected x coordinate value from in the range from to 0 to Length-1.
 		int generateRandomX();
 
 		//! \brief Generates a random y coordinate that lies within the y-dimension size of the lattice.
+		//! \details The coordinate is generated in the same way as in the generateRandomX function.
 		//! \return
 		//! A randomly selected y coordinate value in the range from 0 to Width-1.
 		int generateRandomY();
 
 		//! \brief Generates a random z coordinate that lies within the z-dimension size of the lattice.
+		//! \details The coordinate is generated in the same way as in the generateRandomX function.
 		//! \return
 		//! A randomly selected z coordinate value in the range from 0 to Height-1.
 		int generateRandomZ();
 
+		//! \brief Gets the precomputed hop displacements constructed by the setupHopDisplacements function.
+		//! \return a vector of HopDisplacement structs sorted by increasing distance.
+		const std::vector<HopDisplacement>& getHopDisplacements() const;
+
 		//! \brief Gets the z-direction size of the lattice, the height.
 		//! \return The Height property of the lattice, which is the z-direction size.
 		int getHeight() const;
@@ -148,24 +364,110 @@ namespace KMC_Lattice {
 
 		//! \brief Gets the number of sites contained in the lattice.
 		//! \return The number of sites in the lattice.
-		long int getNumSites() const;
+		int64_t getNumSites() const;
+
+		//! \brief Gets the number of nearest neighbor sites with the input occupant species code.
+		//! \details The site states must be enabled. Neighbors are determined in the same way as in getNumOccupiedNeighbors.
+		//! \param site_index is the vector index of the input site.
+		//! \param species is the occupant species code to be counted.
+		//! \return The number of nearest neighbor sites occupied by the input species, in the range from 0 to 6.
+		int getNumNeighborsOfSpecies(const int64_t site_index, const uint8_t species);
+
+		//! \brief Gets the number of nearest neighbor sites with the input site type code.
+		//! \details The site states must be enabled. Neighbors are determined in the same way as in getNumOccupiedNeighbors.
+		//! \param site_index is the vector index of the input site.
+		//! \param type is the site type code to be counted.
+		//! \return The number of nearest neighbor sites with the input site type, in the range from 0 to 6.
+		int getNumNeighborsOfType(const int64_t site_index, const uint8_t type);
+
+		//! \brief Gets the number of occupied nearest neighbor sites of the site with the input site index.
+		//! \details When the neighbor counts are enabled, the count is maintained by the setOccupied, setObjectPtr, and clearOccupancy
+		//! functions, so this function only needs a single lookup. Otherwise, the occupancy of each neighbor is checked.
+		//! Neighbors across non-periodic boundaries do not exist, and a site is not counted as its own neighbor in periodic directions of size one.
+		//! The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return The number of occupied nearest neighbor sites, in the range from 0 to 6.
+		int getNumOccupiedNeighbors(const int64_t site_index);
+
+		//! \brief Gets the number of occupied nearest neighbor sites of the site located at the input coordinates.
+		//! \param coords is the Coords struct that represents the input coordinates.
+		//! \return The number of occupied nearest neighbor sites, in the range from 0 to 6.
+		int getNumOccupiedNeighbors(const Coords& coords);
+
+		//! \brief Gets the number of unoccupied sites in the lattice.
+		//! \details This function takes constant time when the free site index is enabled and scans the lattice otherwise.
+		//! \return The number of unoccupied sites in the lattice.
+		int64_t getNumUnoccupiedSites() const;
 
 		//! \brief Gets the coordinates of the specified site.
 		//! \param site_index is the vector index of the input site
 		//! \return a Coords object that contains the coordinates of the site specified by the site index.
-		Coords getSiteCoords(long int site_index);
+		Coords getSiteCoords(int64_t site_index);
 
 		//! \brief Gets the vector index for the site corresponding to the input coordinates.
 		//! \param coords is the Coords struct that represents the input coordinates.
 		//! \return The vector index for the sites vector that is associated with the site located at the input coordinates.
 		//! \return -1 if the coordinates are not located in the lattice.
-		long int getSiteIndex(const Coords& coords) const;
+		int64_t getSiteIndex(const Coords& coords) const;
+
+		//! \brief Gets the Cartesian coordinates of the site with the input site index without checking the site index.
+		//! \details This inline function is intended for internal hot paths where the site index is already known to lie
+		//! in the lattice. When the library is compiled with KMC_LATTICE_DEBUG defined, the site index is checked.
+		//! \param site_index is the vector index of the site.
+		//! \return The Coords struct that represents the coordinates of the site.
+		Coords getSiteCoordsUnchecked(const int64_t site_index) const;
+
+		//! \brief Gets the vector index for the site corresponding to the input coordinates without checking the lattice bounds.
+		//! \details This inline function is intended for internal hot paths where the coordinates are already known to lie
+		//! in the lattice. When the library is compiled with KMC_LATTICE_DEBUG defined, the bounds are checked using getSiteIndex.
+		//! \param coords is the Coords struct that represents the input coordinates.
+		//! \return The vector index for the sites vector that is associated with the site located at the input coordinates.
+		int64_t getSiteIndexUnchecked(const Coords& coords) const;
+
+		//! \brief Gets the energy of the site with the input site index.
+		//! \details The site energies must be enabled. The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return The energy of the site.
+		float getSiteEnergy(const int64_t site_index) const;
+
+		//! \brief Gets the array of site energies.
+		//! \return a constant reference to the vector of site energies ordered by site index.
+		const std::vector<float>& getSiteEnergies() const;
+
+		//! \brief Gets the occupant species code of the site with the input site index.
+		//! \details The site states must be enabled. A species code of 0 indicates that the site has no occupant.
+		//! The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return The occupant species code of the site.
+		uint8_t getSiteSpecies(const int64_t site_index) const;
+
+		//! \brief Gets the site type code of the site with the input site index.
+		//! \details The site states must be enabled. The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return The site type code of the site.
+		uint8_t getSiteType(const int64_t site_index) const;
+
+		//! \brief Gets the pointer to the Site object with the input site index.
+		//! \details In sparse storage mode, the Site object is created using the site factory function the first time that it is requested
+		//! and is then kept for the lifetime of the lattice, so this function should only be used for sites that need custom attributes.
+		//! The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return the pointer to the Site object.
+		Site* getSitePtr(const int64_t site_index);
 
 		//! \brief Gets the vector iterator for the site corresponding to the input coordinates.
+		//! \warning This function throws a logic_error exception in sparse storage mode, where the site vector does not exist.
 		//! \param coords is the Coords struct that represents the input coordinates.
 		//! \return The vector iterator for the sites vector that is associated with the site located at the input coordinates.
 		std::vector<Site*>::iterator getSiteIt(const Coords& coords);
 
+		//! \brief Gets the vector iterator for the site with the input site index.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \warning This function throws a logic_error exception in sparse storage mode, where the site vector does not exist.
+		//! \param site_index is the vector index of the input site.
+		//! \return The vector iterator for the sites vector that is associated with the input site index.
+		std::vector<Site*>::iterator getSiteIt(const int64_t site_index);
+
 		//! \brief Gets the lattice unit size, which is used to convert lattice units into real space units.
 		//! \return The unit size property of the lattice.
 		double getUnitSize() const;
@@ -183,6 +485,35 @@ namespace KMC_Lattice {
 		//! \return false if the specified site is unoccupied
 		bool isOccupied(const Coords& coords) const;
 
+		//! \brief Checks whether the site with the input site index is occupied or not.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \return true if the specified site is occupied
+		//! \return false if the specified site is unoccupied
+		bool isOccupied(const int64_t site_index) const;
+
+		//! \brief Checks whether all of the lattice dimensions are powers of two.
+		//! \details When all dimensions are powers of two, the lattice automatically uses bit shifts and masks instead of
+		//! multiplication, division, and modulo operations for the site index, site coordinate, and periodic wrapping calculations.
+		//! \return true if the Length, Width, and Height of the lattice are all powers of two.
+		//! \return false otherwise.
+		bool isPowerOfTwo() const;
+
+		//! \brief Checks whether the lattice is using the sparse storage mode.
+		//! \return true if only the occupied sites are stored in a hash map.
+		//! \return false if a Site pointer is stored for every lattice site.
+		bool isSparse() const;
+
+		//! \brief Checks whether the lattice is storing the energy of every site.
+		//! \return true if the site energies are enabled.
+		//! \return false otherwise.
+		bool isSiteEnergiesEnabled() const;
+
+		//! \brief Checks whether the lattice is storing the site type and occupant species codes of every site.
+		//! \return true if the site states are enabled.
+		//! \return false otherwise.
+		bool isSiteStatesEnabled() const;
+
 		//! \brief Checks whether the x-direction periodic boundaries are enabled or not.
 		//! \return true if periodic boundaries are enabled in the x-direction.
 		//! \return false if periodic boundaries are disabled in the x-direction.
@@ -198,32 +529,618 @@ namespace KMC_Lattice {
 		//! \return false if periodic boundaries are disabled in the z-direction.
 		bool isZPeriodic() const;
 
+		//! \brief Moves the occupant of one site to another site, updating the occupancy of both sites in one operation.
+		//! \details This function has the same effect as calling clearOccupancy for the initial site and setObjectPtr for the
+		//! destination site, except that the occupant species code is moved to the destination site when the site states are enabled.
+		//! The site indices are not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index_initial is the vector index of the site where the occupant is initially located.
+		//! \param site_index_dest is the vector index of the site where the occupant is to be moved.
+		//! \param object_ptr is the pointer to the Object that occupies the site.
+		void moveOccupant(const int64_t site_index_initial, const int64_t site_index_dest, Object* object_ptr);
+
 		//! Prints to the command line which sites are occupied.
 		void outputLatticeOccupancy() const;
 
+		//! \brief Checks whether the lattice is keeping track of the number of occupied neighbors of every site.
+		//! \details When the neighbor counts are enabled, the occupancy of the sites must only be changed using the setOccupied,
+		//! setObjectPtr, and clearOccupancy functions of the Lattice class so that the counts remain up to date.
+		//! \return true if the neighbor counts are enabled.
+		//! \return false otherwise.
+		bool isNeighborCountsEnabled() const;
+
+		//! \brief Checks whether the lattice is maintaining an index of the unoccupied sites.
+		//! \details When the free site index is enabled, the occupancy of the sites must only be changed using the setOccupied and
+		//! clearOccupancy functions of the Lattice class so that the index remains up to date.
+		//! \return true if the free site index is enabled.
+		//! \return false otherwise.
+		bool isFreeSiteIndexEnabled() const;
+
 		//! \brief Sets the site located at the input coordinates to the occupied state.
 		//! \param coords is the Coords struct that represents the input coordinates.
 		void setOccupied(const Coords& coords);
 
+		//! \brief Sets the site with the input site index to the occupied state.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		void setOccupied(const int64_t site_index);
+
+		//! \brief Sets the site with the input site index to the occupied state and assigns the pointer to the occupying Object.
+		//! \details The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \param object_ptr is the pointer to the Object that occupies the site.
+		void setObjectPtr(const int64_t site_index, Object* object_ptr);
+
+		//! \brief Sets the occupant species code of the site with the input site index.
+		//! \details The site states must be enabled. The species code is reset to 0 when the occupancy of the site is cleared.
+		//! The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \param species is the occupant species code.
+		void setSiteSpecies(const int64_t site_index, const uint8_t species);
+
+		//! \brief Sets the site type code of the site with the input site index.
+		//! \details The site states must be enabled. The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \param type is the site type code.
+		void setSiteType(const int64_t site_index, const uint8_t type);
+
+		//! \brief Sets the site type codes of all sites in the lattice.
+		//! \param types is the vector of site type codes, which must contain one entry for each site ordered by site index.
+		//! \return false to indicate an error when the site states are not enabled or the size of the input vector is not equal to the number of sites.
+		//! \return true when no error occurs.
+		bool setSiteTypes(const std::vector<uint8_t>& types);
+
+		//! \brief Sets the site type code of all of the sites with the input site indices.
+		//! \param site_indices is the vector of site indices of the sites to be set.
+		//! \param type is the site type code.
+		//! \return false to indicate an error when the site states are not enabled or any of the site indices are not located in the lattice.
+		//! \return true when no error occurs.
+		bool setSiteTypes(const std::vector<int64_t>& site_indices, const uint8_t type);
+
+		//! \brief Sets the energy of the site with the input site index.
+		//! \details The site energies must be enabled. The site index is not checked unless the library is compiled with KMC_LATTICE_DEBUG defined.
+		//! \param site_index is the vector index of the input site.
+		//! \param energy is the site energy.
+		void setSiteEnergy(const int64_t site_index, const float energy);
+
+		//! \brief Sets the energies of all sites in the lattice.
+		//! \param energies is the vector of site energies, which must contain one entry for each site ordered by site index.
+		//! \return false to indicate an error when the site energies are not enabled or the size of the input vector is not equal to the number of sites.
+		//! \return true when no error occurs.
+		bool setSiteEnergies(const std::vector<float>& energies);
+
+		//! \brief Sets the function used to create Site objects in sparse storage mode.
+		//! \details The default site factory creates base Site objects, so derived lattice site classes must set their own factory.
+		//! \param factory is a function that returns a pointer to a new Site object, which is then owned by the lattice.
+		void setSiteFactory(const std::function<Site*()>& factory);
+
+		//! \brief Constructs the lookup tables used for fast minimum image displacement calculations.
+		//! \details The function builds tables that map every possible raw coordinate difference in each direction to its minimum image
+		//! value, which are used by calculateLatticeDistanceSquared, and a table of DisplacementEntry structs for all minimum image
+		//! displacement vectors with components no larger than the cutoff, which is used by lookupDisplacement.
+		//! \param cutoff is the largest displacement component in lattice units that is included in the displacement table, which must be at least one.
+		void setupDisplacementTable(const int cutoff);
+
+		//! \brief Constructs the table of all hop displacement vectors within the input cutoff radius.
+		//! \details The displacements are sorted into shells of increasing distance, and the tunneling prefactor of each displacement
+		//! is calculated once so that it does not need to be recalculated for every hop. In periodic directions, the displacement components
+		//! are limited to half of the lattice size so that no two displacements lead to the same destination site, and the image at exactly
+		//! half of an even lattice size is only included once with a positive displacement component.
+		//! \param cutoff_radius is the maximum hop distance in nm, which must be at least one lattice unit.
+		//! \param localization is the localization parameter, gamma, in nm^-1 that is used to calculate the tunneling prefactors.
+		void setupHopDisplacements(const double cutoff_radius, const double localization);
+
 		//! \brief Sets the member site pointer vector to the input site pointer vector
+		//! \details When the free site index or the neighbor counts are enabled, they are rebuilt from the current occupancy of the input sites.
+		//! Site pointers cannot be set in sparse storage mode.
 		//! \param input_ptrs is the input site pointer vector
 		//! \return false to indicate an error when the sizes of the input site pointer vector and the member site pointer vector are not equal.
 		//! \return true when no error occurs.
 		bool setSitePointers(const std::vector<Site*>& input_ptrs);
+
+		//! \brief Sets the member site pointer vector to point to the elements of the input vector of sites using multiple threads.
+		//! \details This function allows the sites of large lattices to be stored contiguously in a vector of a derived Site class
+		//! and assigned to the lattice without building a separate site pointer vector. Otherwise, it behaves the same as the
+		//! setSitePointers function.
+		//! \param sites is the input vector of sites, which must not be resized while the lattice uses it.
+		//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+		//! \return false to indicate an error when the size of the input site vector and the member site pointer vector are not equal.
+		//! \return true when no error occurs.
+		template<typename SiteType>
+		bool setSites(std::vector<SiteType>& sites, const int num_threads);
 	protected:
 
 	private:
 		bool Enable_periodic_x;
 		bool Enable_periodic_y;
 		bool Enable_periodic_z;
+		// Periodic boundary settings packed as x*4 + y*2 + z, which selects the compile-time version of the boundary functions
+		int Periodicity_mode = 0;
 		int Length; // nm
 		int Width; // nm
 		int Height; // nm
 		double Unit_size; // nm
+		// Power of two mode bit shifts and masks
+		bool Power_of_two = false;
+		int Index_shift_x = 0;
+		int Index_shift_y = 0;
+		int Wrap_mask_x = -1;
+		int Wrap_mask_y = -1;
+		int Wrap_mask_z = -1;
 		std::vector<Site*> site_ptrs;
-		std::mt19937_64* gen_ptr;
+		RandomEngine* gen_ptr;
+		// Bounded integer samplers for the random coordinates in each direction
+		BoundedSampler32 sampler_x;
+		BoundedSampler32 sampler_y;
+		BoundedSampler32 sampler_z;
+		std::vector<HopDisplacement> hop_displacements;
+		// Sparse storage of the occupied sites and the lazily created Site objects
+		bool Enable_sparse_storage = false;
+		SiteHashMap site_map;
+		std::vector<std::shared_ptr<Site>> sparse_site_ptrs;
+		std::function<Site*()> site_factory = []() { return new Site(); };
+		// Free site index, where free_site_positions holds the position of each site in free_site_indices or -1 when the site is occupied
+		bool Enable_free_site_index = false;
+		std::vector<int64_t> free_site_indices;
+		std::vector<int64_t> free_site_positions;
+
+		// Displacement lookup tables, where the minimum image tables are indexed by the raw coordinate difference plus the lattice size minus one
+		int Displacement_cutoff = 0;
+		std::vector<int> image_delta_x;
+		std::vector<int> image_delta_y;
+		std::vector<int> image_delta_z;
+		std::vector<int> image_delta_sq_x;
+		std::vector<int> image_delta_sq_y;
+		std::vector<int> image_delta_sq_z;
+		std::vector<DisplacementEntry> displacement_table;
+		// Number of occupied nearest neighbors of each site
+		bool Enable_neighbor_counts = false;
+		std::vector<uint8_t> neighbor_counts;
+
+		// Compact site type and occupant species codes of each site
+		bool Enable_site_states = false;
+		std::vector<uint8_t> site_types;
+		std::vector<uint8_t> site_species;
+
+		// Site energies
+		bool Enable_site_energies = false;
+		std::vector<float> site_energies;
+
+		// Adds the input site index to the free site index if it is not already present.
+		void addFreeSite(const int64_t site_index);
+
+		// Removes the input site index from the free site index using a swap with the last entry.
+		void removeFreeSite(const int64_t site_index);
+
+		// Calculates the site index of the destination of the input hop displacement or returns -1 when the hop crosses a non-periodic boundary.
+		int64_t calculateHopDestinationIndex(const Coords& coords, const HopDisplacement& displacement) const;
+
+		// Throws a logic_error exception when the site energies are not enabled.
+		void checkSiteEnergies() const;
+
+		// Finds the site indices of the nearest neighbors of the input site, places them in the neighbor_indices array, which must
+		// have room for six entries, and returns the number of neighbors.
+		int findNeighborIndices(const int64_t site_index, int64_t* neighbor_indices);
+
+		// Adds the input change to the neighbor counts of all nearest neighbors of the input site.
+		void updateNeighborCounts(const int64_t site_index, const int change);
+
+		// Calculates the base two logarithm of the input value or returns -1 if the value is not a power of two.
+		static int calculateLog2(const int value);
+
+		// Checks the input site index and throws an out_of_range exception when it is not located in the lattice.
+		void checkSiteIndex(const int64_t site_index) const;
+
+		// Throws a logic_error exception when the lattice is in sparse storage mode.
+		void checkDenseStorage() const;
+
+		// Checks the input periodic boundary settings and throws a logic_error exception when they do not match the lattice.
+		void checkPeriodicity(const bool periodic_x, const bool periodic_y, const bool periodic_z) const;
+
+		// Calculates the adjustment that wraps a coordinate that has crossed a periodic boundary back into the lattice without branching.
+		template<bool Periodic>
+		static int calculateBoundaryCorrection(const int coord, const int size) {
+			return Periodic ? (coord < 0 ? size : 0) - (coord >= size ? size : 0) : 0;
+		}
+
+		// Calculates the adjustment for a separation that is longer than half of the lattice size in a periodic direction without branching.
+		template<bool Periodic>
+		static int calculateImageCorrection(const int delta, const int size) {
+			return Periodic ? (2 * delta > size ? size : 0) - (2 * delta < -size ? size : 0) : 0;
+		}
+
+		// Calculates the absolute minimum image separation along one direction without branching.
+		template<bool Periodic>
+		static int calculateMinImageSeparation(const int delta, const int size) {
+			int separation = std::abs(delta);
+			return Periodic ? std::min(separation, size - separation) : separation;
+		}
 	};
 
+	// Template function definitions for the compile-time periodic boundary functions
+
+	template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+	void Lattice::calculateDestinationCoords(const Coords& coords_initial, const int i, const int j, const int k, Coords& coords_dest) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkPeriodicity(Periodic_x, Periodic_y, Periodic_z);
+#endif
+		coords_dest.x = coords_initial.x + i + calculateBoundaryCorrection<Periodic_x>(coords_initial.x + i, Length);
+		coords_dest.y = coords_initial.y + j + calculateBoundaryCorrection<Periodic_y>(coords_initial.y + j, Width);
+		coords_dest.z = coords_initial.z + k + calculateBoundaryCorrection<Periodic_z>(coords_initial.z + k, Height);
+	}
+
+	template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+	int Lattice::calculateLatticeDistanceSquared(const Coords& coords_start, const Coords& coords_dest) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkPeriodicity(Periodic_x, Periodic_y, Periodic_z);
+#endif
+		int sep_x = calculateMinImageSeparation<Periodic_x>(coords_dest.x - coords_start.x, Length);
+		int sep_y = calculateMinImageSeparation<Periodic_y>(coords_dest.y - coords_start.y, Width);
+		int sep_z = calculateMinImageSeparation<Periodic_z>(coords_dest.z - coords_start.z, Height);
+		return sep_x * sep_x + sep_y * sep_y + sep_z * sep_z;
+	}
+
+	template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+	bool Lattice::checkMoveValidity(const Coords& coords_initial, const int i, const int j, const int k) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkPeriodicity(Periodic_x, Periodic_y, Periodic_z);
+#endif
+		if (i == 0 && j == 0 && k == 0) {
+			return false;
+		}
+		if (!Periodic_x && (coords_initial.x + i >= Length || coords_initial.x + i < 0)) {
+			return false;
+		}
+		if (!Periodic_y && (coords_initial.y + j >= Width || coords_initial.y + j < 0)) {
+			return false;
+		}
+		if (!Periodic_z && (coords_initial.z + k >= Height || coords_initial.z + k < 0)) {
+			return false;
+		}
+		return true;
+	}
+
+	template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+	Coords Lattice::chooseRandomUnoccupiedNeighbor(const Coords& coords_i) {
+		static const int displacements[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+		Coords coords_candidates[6];
+		int num_unoccupied = 0;
+		Coords coords_f;
+		for (int n = 0; n < 6; n++) {
+			if (checkMoveValidity<Periodic_x, Periodic_y, Periodic_z>(coords_i, displacements[n][0], displacements[n][1], displacements[n][2])) {
+				calculateDestinationCoords<Periodic_x, Periodic_y, Periodic_z>(coords_i, displacements[n][0], displacements[n][1], displacements[n][2], coords_f);
+				if (!isOccupied(getSiteIndexUnchecked(coords_f))) {
+					coords_candidates[num_unoccupied++] = coords_f;
+				}
+			}
+		}
+		if (num_unoccupied == 1) {
+			return coords_candidates[0];
+		}
+		else if (num_unoccupied > 1) {
+			return coords_candidates[BoundedSampler32::generate(*gen_ptr, (uint32_t)num_unoccupied)];
+		}
+		else {
+			return Coords(-1, -1, -1);
+		}
+	}
+
+	template<typename Function>
+	void Lattice::forEachHopDestination(const Coords& coords, Function func) const {
+		for (auto const &item : hop_displacements) {
+			int64_t site_index = calculateHopDestinationIndex(coords, item);
+			if (site_index >= 0) {
+				func(item, site_index);
+			}
+		}
+	}
+
+	template<typename Function>
+	void Lattice::forEachSiteParallel(const int num_threads, Function func) const {
+		parallelFor(0, getNumSites(), num_threads, [&func](const int64_t index_start, const int64_t index_end) {
+			for (int64_t n = index_start; n < index_end; n++) {
+				func(n);
+			}
+		});
+	}
+
+	template<typename SiteType>
+	bool Lattice::setSites(std::vector<SiteType>& sites, const int num_threads) {
+		std::vector<Site*> input_ptrs(sites.size());
+		parallelFor(0, (int64_t)sites.size(), num_threads, [&sites, &input_ptrs](const int64_t index_start, const int64_t index_end) {
+			for (int64_t n = index_start; n < index_end; n++) {
+				input_ptrs[n] = &sites[n];
+			}
+		});
+		return setSitePointers(input_ptrs);
+	}
+
+	// Inline function definitions for the hot path site indexing functions
+
+	inline int64_t Lattice::calculateHopDestinationIndex(const Coords& coords, const HopDisplacement& displacement) const {
+		int x = coords.x + displacement.i;
+		int y = coords.y + displacement.j;
+		int z = coords.z + displacement.k;
+		if (x < 0 || x >= Length) {
+			if (!Enable_periodic_x) {
+				return -1;
+			}
+			x += (x < 0) ? Length : -Length;
+		}
+		if (y < 0 || y >= Width) {
+			if (!Enable_periodic_y) {
+				return -1;
+			}
+			y += (y < 0) ? Width : -Width;
+		}
+		if (z < 0 || z >= Height) {
+			if (!Enable_periodic_z) {
+				return -1;
+			}
+			z += (z < 0) ? Height : -Height;
+		}
+		return getSiteIndexUnchecked(Coords(x, y, z));
+	}
+
+	inline Coords Lattice::generateRandomCoords() {
+		Coords coords;
+		coords.x = generateRandomX();
+		coords.y = generateRandomY();
+		coords.z = generateRandomZ();
+		return coords;
+	}
+
+	inline int Lattice::generateRandomX() {
+		if (Power_of_two) {
+			return (int)((*gen_ptr)() & (Length - 1));
+		}
+		return (int)sampler_x.generate(*gen_ptr);
+	}
+
+	inline int Lattice::generateRandomY() {
+		if (Power_of_two) {
+			return (int)((*gen_ptr)() & (Width - 1));
+		}
+		return (int)sampler_y.generate(*gen_ptr);
+	}
+
+	inline int Lattice::generateRandomZ() {
+		if (Power_of_two) {
+			return (int)((*gen_ptr)() & (Height - 1));
+		}
+		return (int)sampler_z.generate(*gen_ptr);
+	}
+
+	inline Coords Lattice::getSiteCoordsUnchecked(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		Coords coords;
+		if (Power_of_two) {
+			coords.x = (int)(site_index >> Index_shift_x);
+			coords.y = (int)(site_index >> Index_shift_y) & (Width - 1);
+			coords.z = (int)site_index & (Height - 1);
+			return coords;
+		}
+		int64_t area = (int64_t)Width*Height;
+		coords.x = (int)(site_index / area);
+		int64_t remainder = site_index % area;
+		coords.y = (int)(remainder / Height);
+		coords.z = (int)(remainder % Height);
+		return coords;
+	}
+
+	inline int64_t Lattice::getSiteIndexUnchecked(const Coords& coords) const {
+#ifdef KMC_LATTICE_DEBUG
+		return getSiteIndex(coords);
+#else
+		if (Power_of_two) {
+			return ((int64_t)coords.x << Index_shift_x) | ((int64_t)coords.y << Index_shift_y) | coords.z;
+		}
+		return ((int64_t)coords.x*Width + coords.y)*Height + coords.z;
+#endif
+	}
+
+	inline std::vector<Site*>::iterator Lattice::getSiteIt(const int64_t site_index) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			checkDenseStorage();
+		}
+		return site_ptrs.begin() + site_index;
+	}
+
+	inline bool Lattice::isOccupied(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			const SiteHashMap::Entry* entry_ptr = site_map.find(site_index);
+			return entry_ptr != nullptr && entry_ptr->occupied;
+		}
+		return site_ptrs[site_index]->isOccupied();
+	}
+
+	inline void Lattice::clearOccupancy(const int64_t site_index) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			SiteHashMap::Entry* entry_ptr = site_map.find(site_index);
+			if (entry_ptr == nullptr) {
+				return;
+			}
+			// Sites without created Site objects do not need to be stored when they are unoccupied
+			if (entry_ptr->site_ptr == nullptr) {
+				site_map.erase(site_index);
+				return;
+			}
+			entry_ptr->occupied = false;
+			entry_ptr->object_ptr = nullptr;
+			entry_ptr->site_ptr->clearOccupancy();
+			return;
+		}
+		if (Enable_neighbor_counts && site_ptrs[site_index]->isOccupied()) {
+			updateNeighborCounts(site_index, -1);
+		}
+		if (Enable_site_states) {
+			site_species[site_index] = 0;
+		}
+		site_ptrs[site_index]->clearOccupancy();
+		if (Enable_free_site_index) {
+			addFreeSite(site_index);
+		}
+	}
+
+	inline void Lattice::setOccupied(const int64_t site_index) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			SiteHashMap::Entry& entry = site_map.insert(site_index);
+			entry.occupied = true;
+			if (entry.site_ptr != nullptr) {
+				entry.site_ptr->setOccupied();
+			}
+			return;
+		}
+		if (Enable_neighbor_counts && !site_ptrs[site_index]->isOccupied()) {
+			updateNeighborCounts(site_index, 1);
+		}
+		site_ptrs[site_index]->setOccupied();
+		if (Enable_free_site_index) {
+			removeFreeSite(site_index);
+		}
+	}
+
+	inline void Lattice::setObjectPtr(const int64_t site_index, Object* object_ptr) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		if (Enable_sparse_storage) {
+			SiteHashMap::Entry& entry = site_map.insert(site_index);
+			entry.occupied = true;
+			entry.object_ptr = object_ptr;
+			if (entry.site_ptr != nullptr) {
+				entry.site_ptr->setObjectPtr(object_ptr);
+			}
+			return;
+		}
+		if (Enable_neighbor_counts && !site_ptrs[site_index]->isOccupied()) {
+			updateNeighborCounts(site_index, 1);
+		}
+		site_ptrs[site_index]->setObjectPtr(object_ptr);
+		if (Enable_free_site_index) {
+			removeFreeSite(site_index);
+		}
+	}
+
+	inline Coords Lattice::calculateImageShift(const Coords& coords_initial, const Coords& coords_dest) const {
+		int delta_x = coords_dest.x - coords_initial.x;
+		int delta_y = coords_dest.y - coords_initial.y;
+		int delta_z = coords_dest.z - coords_initial.z;
+		Coords shift;
+		shift.x = Enable_periodic_x ? -calculateImageCorrection<true>(delta_x, Length) : 0;
+		shift.y = Enable_periodic_y ? -calculateImageCorrection<true>(delta_y, Width) : 0;
+		shift.z = Enable_periodic_z ? -calculateImageCorrection<true>(delta_z, Height) : 0;
+		return shift;
+	}
+
+	inline void Lattice::moveOccupant(const int64_t site_index_initial, const int64_t site_index_dest, Object* object_ptr) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index_initial);
+		checkSiteIndex(site_index_dest);
+#endif
+		if (Enable_sparse_storage) {
+			clearOccupancy(site_index_initial);
+			setObjectPtr(site_index_dest, object_ptr);
+			return;
+		}
+		Site* site_initial_ptr = site_ptrs[site_index_initial];
+		Site* site_dest_ptr = site_ptrs[site_index_dest];
+		uint8_t species = 0;
+		if (Enable_site_states) {
+			species = site_species[site_index_initial];
+			site_species[site_index_initial] = 0;
+		}
+		// Clear the initial site before setting the destination site, so that the neighbor counts stay correct for adjacent sites
+		if (Enable_neighbor_counts && site_initial_ptr->isOccupied()) {
+			updateNeighborCounts(site_index_initial, -1);
+		}
+		site_initial_ptr->clearOccupancy();
+		if (Enable_neighbor_counts && !site_dest_ptr->isOccupied()) {
+			updateNeighborCounts(site_index_dest, 1);
+		}
+		site_dest_ptr->setObjectPtr(object_ptr);
+		if (Enable_free_site_index) {
+			addFreeSite(site_index_initial);
+			removeFreeSite(site_index_dest);
+		}
+		if (Enable_site_states) {
+			site_species[site_index_dest] = species;
+		}
+	}
+
+	inline float Lattice::getSiteEnergy(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		return site_energies[site_index];
+	}
+
+	inline void Lattice::setSiteEnergy(const int64_t site_index, const float energy) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		site_energies[site_index] = energy;
+	}
+
+	inline uint8_t Lattice::getSiteSpecies(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		return site_species[site_index];
+	}
+
+	inline uint8_t Lattice::getSiteType(const int64_t site_index) const {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		return site_types[site_index];
+	}
+
+	inline void Lattice::setSiteSpecies(const int64_t site_index, const uint8_t species) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		site_species[site_index] = species;
+	}
+
+	inline void Lattice::setSiteType(const int64_t site_index, const uint8_t type) {
+#ifdef KMC_LATTICE_DEBUG
+		checkSiteIndex(site_index);
+#endif
+		site_types[site_index] = type;
+	}
+
+	inline void Lattice::addFreeSite(const int64_t site_index) {
+		if (free_site_positions[site_index] < 0) {
+			free_site_positions[site_index] = (int64_t)free_site_indices.size();
+			free_site_indices.push_back(site_index);
+		}
+	}
+
+	inline void Lattice::removeFreeSite(const int64_t site_index) {
+		int64_t position = free_site_positions[site_index];
+		if (position >= 0) {
+			int64_t last_index = free_site_indices.back();
+			free_site_indices[position] = last_index;
+			free_site_positions[last_index] = position;
+			free_site_indices.pop_back();
+			free_site_positions[site_index] = -1;
+		}
+	}
+
 }
 
 #endif // KMC_LATTICE_LATTICE_H
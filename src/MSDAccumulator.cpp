@@ -0,0 +1,153 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#include "MSDAccumulator.h"
+
+using namespace std;
+
+namespace KMC_Lattice {
+
+	MSDAccumulator::MSDAccumulator() {
+
+	}
+
+	vector<pair<double, double>> MSDAccumulator::calculateDiffusionCoefficients(const double unit_size, const int dimension) const {
+		if (!(unit_size > 0)) {
+			cout << "Error! The lattice unit size must be greater than zero." << endl;
+			throw invalid_argument("Error! The lattice unit size must be greater than zero.");
+		}
+		if (dimension < 1 || dimension > 3) {
+			cout << "Error! The dimension must be 1, 2, or 3." << endl;
+			throw invalid_argument("Error! The dimension must be 1, 2, or 3.");
+		}
+		auto msd_data = calculateMeanSquaredDisplacements();
+		// Convert the lattice units squared to cm^2
+		double conversion = (unit_size*1e-7)*(unit_size*1e-7);
+		for (auto& item : msd_data) {
+			item.second *= conversion / (2.0 * dimension * item.first);
+		}
+		return msd_data;
+	}
+
+	vector<pair<double, double>> MSDAccumulator::calculateMeanSquaredDisplacements(const int direction) const {
+		if (direction < 0 || direction > 3) {
+			throw invalid_argument("Error! Specified direction input parameter is invalid.");
+		}
+		vector<pair<double, double>> msd_data;
+		msd_data.reserve(sample_times.size());
+		for (int i = 0; i < (int)sample_times.size(); i++) {
+			if (sample_counts[i] == 0) {
+				continue;
+			}
+			double sum_sq;
+			switch (direction) {
+			case 1:
+				sum_sq = sums_sq_x[i];
+				break;
+			case 2:
+				sum_sq = sums_sq_y[i];
+				break;
+			case 3:
+				sum_sq = sums_sq_z[i];
+				break;
+			default:
+				sum_sq = sums_sq_x[i] + sums_sq_y[i] + sums_sq_z[i];
+			}
+			msd_data.push_back(make_pair(sample_times[i], sum_sq / sample_counts[i]));
+		}
+		return msd_data;
+	}
+
+	void MSDAccumulator::clear() {
+		sample_counts.assign(sample_times.size(), 0);
+		sums_sq_x.assign(sample_times.size(), 0.0);
+		sums_sq_y.assign(sample_times.size(), 0.0);
+		sums_sq_z.assign(sample_times.size(), 0.0);
+	}
+
+	int MSDAccumulator::getNumSampleTimes() const {
+		return (int)sample_times.size();
+	}
+
+	vector<int64_t> MSDAccumulator::getSampleCounts() const {
+		return sample_counts;
+	}
+
+	vector<double> MSDAccumulator::getSampleTimes() const {
+		return sample_times;
+	}
+
+	void MSDAccumulator::init(const double time_min, const double time_max, const int bins_per_decade) {
+		if (!(time_min > 0) || !(time_max >= time_min) || !(bins_per_decade > 0)) {
+			cout << "Error! The mean squared displacement sample times require time_min > 0, time_max >= time_min, and bins_per_decade > 0." << endl;
+			throw invalid_argument("Error! The mean squared displacement sample times require time_min > 0, time_max >= time_min, and bins_per_decade > 0.");
+		}
+		// A small tolerance keeps time_max as the last sample time when it is an exact number of bins from time_min
+		int num_times = (int)floor(bins_per_decade*log10(time_max / time_min) + 1e-9) + 1;
+		sample_times.resize(num_times);
+		for (int i = 0; i < num_times; i++) {
+			sample_times[i] = time_min * pow(10.0, (double)i / bins_per_decade);
+		}
+		clear();
+	}
+
+	void MSDAccumulator::merge(const MSDAccumulator& input) {
+		if (input.sample_times != sample_times) {
+			cout << "Error! The accumulators cannot be merged because they have different sample times." << endl;
+			throw invalid_argument("Error! The accumulators cannot be merged because they have different sample times.");
+		}
+		for (int i = 0; i < (int)sample_times.size(); i++) {
+			sample_counts[i] += input.sample_counts[i];
+			sums_sq_x[i] += input.sums_sq_x[i];
+			sums_sq_y[i] += input.sums_sq_y[i];
+			sums_sq_z[i] += input.sums_sq_z[i];
+		}
+	}
+
+	void MSDAccumulator::MPI_merge() {
+		int procid;
+		MPI_Comm_rank(MPI_COMM_WORLD, &procid);
+		// Check that all processors use the same sample times
+		int num_times = (int)sample_times.size();
+		auto num_times_all = MPI_gatherValues(num_times);
+		auto sample_times_all = MPI_gatherVectors(sample_times);
+		int success = 1;
+		if (procid == 0) {
+			for (auto const &item : num_times_all) {
+				if (item != num_times) {
+					success = 0;
+				}
+			}
+			for (int i = 0; success == 1 && i < (int)sample_times_all.size(); i++) {
+				if (sample_times_all[i] != sample_times[i % num_times]) {
+					success = 0;
+				}
+			}
+		}
+		MPI_Bcast(&success, 1, MPI_INT, 0, MPI_COMM_WORLD);
+		if (success == 0) {
+			cout << procid << ": Error! The accumulators cannot be merged because they have different sample times." << endl;
+			throw invalid_argument("Error! The accumulators cannot be merged because they have different sample times.");
+		}
+		// Pack the counts and sums into one vector, which represents the counts exactly up to 2^53 samples
+		vector<double> data(4 * num_times);
+		for (int i = 0; i < num_times; i++) {
+			data[4 * i] = (double)sample_counts[i];
+			data[4 * i + 1] = sums_sq_x[i];
+			data[4 * i + 2] = sums_sq_y[i];
+			data[4 * i + 3] = sums_sq_z[i];
+		}
+		auto data_sum = MPI_calculateVectorSum(data);
+		if (procid == 0) {
+			for (int i = 0; i < num_times; i++) {
+				sample_counts[i] = (int64_t)data_sum[4 * i];
+				sums_sq_x[i] = data_sum[4 * i + 1];
+				sums_sq_y[i] = data_sum[4 * i + 2];
+				sums_sq_z[i] = data_sum[4 * i + 3];
+			}
+		}
+	}
+
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software package.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#ifndef KMC_LATTICE_MSDACCUMULATOR_H
+#define KMC_LATTICE_MSDACCUMULATOR_H
+
+#include "Utils.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace KMC_Lattice {
+
+	//! \brief This class accumulates the mean squared displacement of objects at logarithmically spaced sample times.
+	//! \details The sample times are measured from the creation time of each object and are spaced evenly on a logarithmic scale.
+	//! For each sample time, only the number of samples and the sums of the squared displacements in each direction are stored, so the memory
+	//! usage does not depend on the number of objects or on the length of the simulation. The Simulation class records the displacement of an
+	//! object for all of the sample times that have passed since its previous move just before it is moved or removed. Accumulators with
+	//! the same sample times can be merged, including across processors using MPI, to calculate the mean squared displacement and the
+	//! diffusion coefficient of the combined data.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class MSDAccumulator {
+	public:
+		//! Default constructor that creates an empty MSDAccumulator object without any sample times.
+		MSDAccumulator();
+
+		//! \brief Adds a sample with the input net displacement at the input sample time.
+		//! \param sample_index is the index of the sample time.
+		//! \param net_x is the net displacement in the x-direction in lattice units.
+		//! \param net_y is the net displacement in the y-direction in lattice units.
+		//! \param net_z is the net displacement in the z-direction in lattice units.
+		void addSample(const int sample_index, const int net_x, const int net_y, const int net_z);
+
+		//! \brief Calculates the diffusion coefficient at each sample time that has at least one sample.
+		//! \details The diffusion coefficient is calculated from the Einstein relation, D = MSD / (2 * dimension * t).
+		//! \param unit_size is the lattice unit size in nm.
+		//! \param dimension is the number of dimensions in which the objects are able to move, which must be 1, 2, or 3.
+		//! \return a vector of pairs with the sample times in seconds and the diffusion coefficients in cm^2 s^-1.
+		std::vector<std::pair<double, double>> calculateDiffusionCoefficients(const double unit_size, const int dimension) const;
+
+		//! \brief Calculates the mean squared displacement at each sample time that has at least one sample.
+		//! \param direction is an optional parameter that has the same meaning as in the Object calculateDisplacement function, where the
+		//! default value of zero selects the three-dimensional displacement and 1, 2, or 3 select the x-, y-, or z-direction.
+		//! \return a vector of pairs with the sample times in seconds and the mean squared displacements in lattice units squared.
+		std::vector<std::pair<double, double>> calculateMeanSquaredDisplacements(const int direction = 0) const;
+
+		//! Resets all of the samples while keeping the sample times.
+		void clear();
+
+		//! \brief Gets the number of sample times.
+		int getNumSampleTimes() const;
+
+		//! \brief Gets the number of samples that have been added at each sample time.
+		std::vector<int64_t> getSampleCounts() const;
+
+		//! \brief Gets the sample times in seconds.
+		std::vector<double> getSampleTimes() const;
+
+		//! \brief Initializes the logarithmically spaced sample times.
+		//! \param time_min is the first sample time in seconds.
+		//! \param time_max is the largest allowed sample time in seconds.
+		//! \param bins_per_decade is the number of sample times in each factor of ten in time.
+		void init(const double time_min, const double time_max, const int bins_per_decade);
+
+		//! \brief Adds the samples of the input accumulator to this accumulator.
+		//! \param input is the MSDAccumulator to be merged, which must have the same sample times.
+		void merge(const MSDAccumulator& input);
+
+		//! \brief Uses MPI to add the samples of the accumulators from all processors.
+		//! \details The accumulators on all processors must have the same sample times. The combined samples are placed in the
+		//! accumulator on processor 0, and the accumulators on the other processors are not changed.
+		void MPI_merge();
+
+		//! \brief Adds samples with the input net displacement for all of the sample times that are not after the input elapsed time.
+		//! \details This function is used to record the displacement of an object that has stayed at the same position since its previous move.
+		//! \param sample_index is the index of the next sample time of the object.
+		//! \param elapsed_time is the time since the creation of the object in seconds.
+		//! \param net_x is the net displacement in the x-direction in lattice units.
+		//! \param net_y is the net displacement in the y-direction in lattice units.
+		//! \param net_z is the net displacement in the z-direction in lattice units.
+		//! \return the index of the next sample time of the object.
+		int recordDisplacement(int sample_index, const double elapsed_time, const int net_x, const int net_y, const int net_z);
+
+	private:
+		std::vector<double> sample_times;
+		std::vector<int64_t> sample_counts;
+		std::vector<double> sums_sq_x;
+		std::vector<double> sums_sq_y;
+		std::vector<double> sums_sq_z;
+	};
+
+	inline void MSDAccumulator::addSample(const int sample_index, const int net_x, const int net_y, const int net_z) {
+		sample_counts[sample_index]++;
+		sums_sq_x[sample_index] += (double)net_x * net_x;
+		sums_sq_y[sample_index] += (double)net_y * net_y;
+		sums_sq_z[sample_index] += (double)net_z * net_z;
+	}
+
+	inline int MSDAccumulator::recordDisplacement(int sample_index, const double elapsed_time, const int net_x, const int net_y, const int net_z) {
+		while (sample_index < (int)sample_times.size() && sample_times[sample_index] <= elapsed_time) {
+			addSample(sample_index, net_x, net_y, net_z);
+			sample_index++;
+		}
+		return sample_index;
+	}
+
+}
+
+#endif // KMC_LATTICE_MSDACCUMULATOR_H
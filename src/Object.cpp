@@ -57,10 +57,26 @@ namespace KMC_Lattice {
 		return object_type_base;
 	}
 
+	uint64_t Object::getRandomCounter() const {
+		return random_counter;
+	}
+
+	int64_t Object::getSiteIndex() const {
+		return site_index;
+	}
+
+	int64_t Object::getStoreIndex() const {
+		return store_index;
+	}
+
 	int Object::getTag() const {
 		return tag;
 	}
 
+	void Object::incrementRandomCounter() {
+		random_counter++;
+	}
+
 	void Object::incrementDX(const int num) {
 		dx += num;
 	}
@@ -73,6 +89,14 @@ namespace KMC_Lattice {
 		dz += num;
 	}
 
+	void Object::moveTo(const Coords& coords_dest, const int64_t site_index_dest, const Coords& image_shift) {
+		dx += image_shift.x;
+		dy += image_shift.y;
+		dz += image_shift.z;
+		coords_current = coords_dest;
+		site_index = site_index_dest;
+	}
+
 	void Object::resetInitialCoords(const Coords& input_coords) {
 		coords_initial = input_coords;
 		dx = 0;
@@ -82,10 +106,24 @@ namespace KMC_Lattice {
 
 	void Object::setCoords(const Coords& input_coords) {
 		coords_current = input_coords;
+		site_index = -1;
+	}
+
+	void Object::setCoords(const Coords& input_coords, const int64_t input_site_index) {
+		coords_current = input_coords;
+		site_index = input_site_index;
 	}
 
 	void Object::setEventIt(const list<Event*>::iterator input_it) {
 		event_it = input_it;
 	}
 
+	void Object::setSiteIndex(const int64_t input_site_index) {
+		site_index = input_site_index;
+	}
+
+	void Object::setStoreIndex(const int64_t input_store_index) {
+		store_index = input_store_index;
+	}
+
 }
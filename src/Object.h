@@ -61,6 +61,21 @@ namespace KMC_Lattice {
 		//! \return "Object" when called on the base class.
 		virtual std::string getObjectType() const;
 
+		//! \brief Gets the number of random numbers that have been drawn from the counter-based random number stream of the Object.
+		//! \details The counter is used together with the tag id number to select the next block of the stream by the Simulation rand01 function.
+		uint64_t getRandomCounter() const;
+
+		//! \brief Gets the lattice site index of the current coordinates of the Object.
+		//! \details The site index is set by the Simulation class when the Object is added or moved, so that the Lattice
+		//! functions can be called without recalculating the site index from the coordinates.
+		//! \return the vector index of the site where the Object is located.
+		//! \return -1 if the site index has not been set since the coordinates were last changed.
+		int64_t getSiteIndex() const;
+
+		//! \brief Gets the position of the Object in the ObjectStore of the Simulation class.
+		//! \return -1 if the Object is not in an object store.
+		int64_t getStoreIndex() const;
+
 		//! \brief Gets the tag id number of the Object.
 		//! \warning This tag id number may not be unique between objects that are of different derived object classes.
 		int getTag() const;
@@ -77,15 +92,39 @@ namespace KMC_Lattice {
 		//! \param num is the input increment amount.
 		void incrementDZ(const int num);
 
+		//! \brief Increments the counter of the counter-based random number stream of the Object.
+		void incrementRandomCounter();
+
+		//! \brief Moves the Object to the input coordinates and site index and adds the periodic image shift to the boundary crossing counters.
+		//! \details This function is equivalent to calling the incrementDX, incrementDY, incrementDZ, and setCoords functions.
+		//! \param coords_dest is the Coords struct that designates the destination coordinates.
+		//! \param site_index_dest is the vector index of the lattice site with the destination coordinates.
+		//! \param image_shift is the Coords struct containing the increments of the dx, dy, and dz counters, which is calculated by the Lattice calculateImageShift function.
+		void moveTo(const Coords& coords_dest, const int64_t site_index_dest, const Coords& image_shift);
+
 		//! \brief Resets the initial coordinates of the Object
 		//! \details The dx, dy, and dz member variables that keep track of adjustments for crossing periodic boundaries are also reset to zero.
 		//! \param input_coords is the Coords struct that designates the input coordinates and will be copied to the coords_initial member variable.
 		void resetInitialCoords(const Coords& input_coords);
 
 		//! \brief Sets the coordinates of the Object
+		//! \details The stored site index is reset to -1, because it no longer matches the new coordinates.
 		//! \param input_coords is the Coords struct that designates the input coordinates that will be copied to the coords_current member variable.
 		void setCoords(const Coords& input_coords);
 
+		//! \brief Sets the coordinates of the Object and the matching lattice site index.
+		//! \param input_coords is the Coords struct that designates the input coordinates that will be copied to the coords_current member variable.
+		//! \param input_site_index is the vector index of the lattice site with the input coordinates.
+		void setCoords(const Coords& input_coords, const int64_t input_site_index);
+
+		//! \brief Sets the lattice site index of the current coordinates of the Object.
+		//! \param input_site_index is the vector index of the lattice site with the current coordinates.
+		void setSiteIndex(const int64_t input_site_index);
+
+		//! \brief Sets the position of the Object in the ObjectStore of the Simulation class.
+		//! \param input_store_index is the position of the Object in the store or -1 when the Object is removed from the store.
+		void setStoreIndex(const int64_t input_store_index);
+
 		//! \brief Sets the iterator that points to a specific entry in the events list within the Simulation class.
 		//! \param input_it is the input event list iterator.
 		void setEventIt(const std::list<Event*>::iterator input_it);
@@ -96,6 +135,8 @@ namespace KMC_Lattice {
 		int tag = -1;
 		// Current coords
 		Coords coords_current = { -1,-1,-1 };
+		// Site index of the current coords
+		int64_t site_index = -1;
 		// Initial coords
 		Coords coords_initial = { -1,-1,-1 };
 		std::list<Event*>::iterator event_it;
@@ -103,6 +144,10 @@ namespace KMC_Lattice {
 		int dx = 0;
 		int dy = 0;
 		int dz = 0;
+		// Counter of the counter-based random number stream
+		uint64_t random_counter = 0;
+		// Position in the object store
+		int64_t store_index = -1;
 	};
 
 }
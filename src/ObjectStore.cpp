@@ -0,0 +1,218 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#include "ObjectStore.h"
+
+using namespace std;
+
+namespace KMC_Lattice {
+
+	ObjectStore::ObjectStore() {
+
+	}
+
+	int64_t ObjectStore::addObject(Object* object_ptr) {
+		int64_t index = (int64_t)object_ptrs.size();
+		object_ptrs.push_back(object_ptr);
+		Coords coords = object_ptr->getCoords();
+		x.push_back(coords.x);
+		y.push_back(coords.y);
+		z.push_back(coords.z);
+		net_x.push_back((int)object_ptr->calculateDisplacement(1));
+		net_y.push_back((int)object_ptr->calculateDisplacement(2));
+		net_z.push_back((int)object_ptr->calculateDisplacement(3));
+		creation_times.push_back(object_ptr->getCreationTime());
+		tags.push_back(object_ptr->getTag());
+		sample_indices.push_back(0);
+		object_ptr->setStoreIndex(index);
+		return index;
+	}
+
+	double ObjectStore::calculateMeanSquaredDisplacement(const int direction) const {
+		if (direction < 0 || direction > 3) {
+			throw invalid_argument("Error! Specified direction input parameter is invalid.");
+		}
+		int64_t num_objects = size();
+		if (num_objects == 0) {
+			return 0.0;
+		}
+		// The squares are summed as doubles, which are exact for displacements below 2^26 lattice units and allow the loop to be vectorized
+		const int* data_x = net_x.data();
+		const int* data_y = net_y.data();
+		const int* data_z = net_z.data();
+		double sum = 0.0;
+		if (direction == 0) {
+			for (int64_t i = 0; i < num_objects; i++) {
+				double dx = (double)data_x[i];
+				double dy = (double)data_y[i];
+				double dz = (double)data_z[i];
+				sum += dx * dx + dy * dy + dz * dz;
+			}
+		}
+		else {
+			const int* data = (direction == 1) ? data_x : ((direction == 2) ? data_y : data_z);
+			for (int64_t i = 0; i < num_objects; i++) {
+				double d = (double)data[i];
+				sum += d * d;
+			}
+		}
+		return sum / num_objects;
+	}
+
+	void ObjectStore::calculateSquaredDisplacements(vector<double>& output) const {
+		int64_t num_objects = size();
+		output.resize(num_objects);
+		const int* data_x = net_x.data();
+		const int* data_y = net_y.data();
+		const int* data_z = net_z.data();
+		double* data_out = output.data();
+		for (int64_t i = 0; i < num_objects; i++) {
+			double dx = (double)data_x[i];
+			double dy = (double)data_y[i];
+			double dz = (double)data_z[i];
+			data_out[i] = dx * dx + dy * dy + dz * dz;
+		}
+	}
+
+	int64_t ObjectStore::checkObject(const Object* object_ptr) const {
+		int64_t index = object_ptr->getStoreIndex();
+		if (index < 0 || index >= size() || object_ptrs[index] != object_ptr) {
+			cout << "Error! The Object pointer could not be found in the object store." << endl;
+			throw invalid_argument("Error! The Object pointer could not be found in the object store.");
+		}
+		return index;
+	}
+
+	void ObjectStore::clear() {
+		resize(0);
+	}
+
+	const vector<double>& ObjectStore::getCreationTimes() const {
+		return creation_times;
+	}
+
+	const vector<int>& ObjectStore::getNetX() const {
+		return net_x;
+	}
+
+	const vector<int>& ObjectStore::getNetY() const {
+		return net_y;
+	}
+
+	const vector<int>& ObjectStore::getNetZ() const {
+		return net_z;
+	}
+
+	const vector<Object*>& ObjectStore::getObjectPtrs() const {
+		return object_ptrs;
+	}
+
+	const vector<int>& ObjectStore::getTags() const {
+		return tags;
+	}
+
+	const vector<int>& ObjectStore::getX() const {
+		return x;
+	}
+
+	const vector<int>& ObjectStore::getY() const {
+		return y;
+	}
+
+	const vector<int>& ObjectStore::getZ() const {
+		return z;
+	}
+
+	void ObjectStore::moveEntry(const int64_t index_src, const int64_t index_dest) {
+		object_ptrs[index_dest] = object_ptrs[index_src];
+		x[index_dest] = x[index_src];
+		y[index_dest] = y[index_src];
+		z[index_dest] = z[index_src];
+		net_x[index_dest] = net_x[index_src];
+		net_y[index_dest] = net_y[index_src];
+		net_z[index_dest] = net_z[index_src];
+		creation_times[index_dest] = creation_times[index_src];
+		tags[index_dest] = tags[index_src];
+		sample_indices[index_dest] = sample_indices[index_src];
+		object_ptrs[index_dest]->setStoreIndex(index_dest);
+	}
+
+	void ObjectStore::removeObject(Object* object_ptr) {
+		int64_t index = checkObject(object_ptr);
+		int64_t num_objects = size();
+		// Shift the following entries to keep the order of the store
+		for (int64_t i = index + 1; i < num_objects; i++) {
+			moveEntry(i, i - 1);
+		}
+		resize(num_objects - 1);
+		object_ptr->setStoreIndex(-1);
+	}
+
+	void ObjectStore::removeObjects(const vector<Object*>& input_ptrs) {
+		int64_t num_objects = size();
+		vector<bool> remove_flags(num_objects, false);
+		for (auto const &item : input_ptrs) {
+			remove_flags[checkObject(item)] = true;
+		}
+		for (auto const &item : input_ptrs) {
+			item->setStoreIndex(-1);
+		}
+		// Compact the remaining entries in one pass
+		int64_t index_dest = 0;
+		for (int64_t i = 0; i < num_objects; i++) {
+			if (!remove_flags[i]) {
+				if (i != index_dest) {
+					moveEntry(i, index_dest);
+				}
+				index_dest++;
+			}
+		}
+		resize(index_dest);
+	}
+
+	void ObjectStore::reserve(const size_t capacity) {
+		object_ptrs.reserve(capacity);
+		x.reserve(capacity);
+		y.reserve(capacity);
+		z.reserve(capacity);
+		net_x.reserve(capacity);
+		net_y.reserve(capacity);
+		net_z.reserve(capacity);
+		creation_times.reserve(capacity);
+		tags.reserve(capacity);
+		sample_indices.reserve(capacity);
+	}
+
+	void ObjectStore::resize(const int64_t num_objects) {
+		object_ptrs.resize(num_objects);
+		x.resize(num_objects);
+		y.resize(num_objects);
+		z.resize(num_objects);
+		net_x.resize(num_objects);
+		net_y.resize(num_objects);
+		net_z.resize(num_objects);
+		creation_times.resize(num_objects);
+		tags.resize(num_objects);
+		sample_indices.resize(num_objects);
+	}
+
+	int64_t ObjectStore::size() const {
+		return (int64_t)object_ptrs.size();
+	}
+
+	void ObjectStore::updateObject(Object* object_ptr) {
+		int64_t index = checkObject(object_ptr);
+		Coords coords = object_ptr->getCoords();
+		x[index] = coords.x;
+		y[index] = coords.y;
+		z[index] = coords.z;
+		net_x[index] = (int)object_ptr->calculateDisplacement(1);
+		net_y[index] = (int)object_ptr->calculateDisplacement(2);
+		net_z[index] = (int)object_ptr->calculateDisplacement(3);
+		creation_times[index] = object_ptr->getCreationTime();
+		tags[index] = object_ptr->getTag();
+	}
+
+}
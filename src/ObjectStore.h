@@ -0,0 +1,154 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software package.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#ifndef KMC_LATTICE_OBJECTSTORE_H
+#define KMC_LATTICE_OBJECTSTORE_H
+
+#include "Object.h"
+#include "Utils.h"
+#include <cstdint>
+#include <vector>
+
+namespace KMC_Lattice {
+
+	//! \brief This class stores the state of all objects in a simulation using a structure-of-arrays layout.
+	//! \details The coordinates, net displacements, creation times, and tags of the objects are stored in separate contiguous
+	//! arrays, so that calculations over all objects, such as the mean squared displacement or the distances used for the event
+	//! recalculation, do not need to follow a pointer to each Object. The store is maintained by the Simulation class when
+	//! objects are added, moved, and removed, and the entries are kept in the same order as the object list of the Simulation class.
+	//! The position of each Object in the store is saved in the Object, so that it can be moved without searching the store.
+	//! \warning Objects that are moved without using the Simulation moveObject functions must be updated with the Simulation
+	//! updateObjectStore function, which calls the updateObject function of the store.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class ObjectStore {
+	public:
+		//! Default constructor that creates an empty ObjectStore object.
+		ObjectStore();
+
+		//! \brief Adds the input Object to the end of the store and saves its position in the Object.
+		//! \param object_ptr is the pointer to the Object to be added.
+		//! \return the position of the Object in the store.
+		int64_t addObject(Object* object_ptr);
+
+		//! \brief Calculates the mean squared displacement of all objects in the store in units of lattice units squared.
+		//! \param direction is an optional parameter that has the same meaning as in the Object calculateDisplacement function, where the
+		//! default value of zero selects the three-dimensional displacement and 1, 2, or 3 select the x-, y-, or z-direction.
+		//! \return the mean squared displacement or zero when the store is empty.
+		double calculateMeanSquaredDisplacement(const int direction = 0) const;
+
+		//! \brief Calculates the squared three-dimensional displacement of each object in the store in units of lattice units squared.
+		//! \param output is the vector where the squared displacements are placed in the order of the store entries, which is resized as needed.
+		void calculateSquaredDisplacements(std::vector<double>& output) const;
+
+		//! \brief Checks that the input Object is in the store.
+		//! \param object_ptr is the pointer to the Object to be checked.
+		//! \return the position of the Object in the store.
+		//! \warning This function throws an invalid_argument exception when the Object is not in the store.
+		int64_t checkObject(const Object* object_ptr) const;
+
+		//! \brief Removes all objects from the store.
+		//! \details The objects are not accessed, so this function can be called after the objects have been deleted.
+		void clear();
+
+		//! \brief Gets the creation times of the objects.
+		const std::vector<double>& getCreationTimes() const;
+
+		//! \brief Gets the net displacements of the objects in the x-direction in lattice units, which account for the periodic boundary crossings.
+		const std::vector<int>& getNetX() const;
+
+		//! \brief Gets the net displacements of the objects in the y-direction in lattice units, which account for the periodic boundary crossings.
+		const std::vector<int>& getNetY() const;
+
+		//! \brief Gets the net displacements of the objects in the z-direction in lattice units, which account for the periodic boundary crossings.
+		const std::vector<int>& getNetZ() const;
+
+		//! \brief Gets the pointers to the objects in the order of the store entries.
+		const std::vector<Object*>& getObjectPtrs() const;
+
+		//! \brief Gets the index of the next mean squared displacement sample time of the object at the input position of the store.
+		//! \details The sample index is used by the Simulation class to record the displacement of each object with the MSDAccumulator class.
+		int getSampleIndex(const int64_t index) const;
+
+		//! \brief Gets the tag id numbers of the objects.
+		const std::vector<int>& getTags() const;
+
+		//! \brief Gets the current x coordinates of the objects.
+		const std::vector<int>& getX() const;
+
+		//! \brief Gets the current y coordinates of the objects.
+		const std::vector<int>& getY() const;
+
+		//! \brief Gets the current z coordinates of the objects.
+		const std::vector<int>& getZ() const;
+
+		//! \brief Moves the object at the input position of the store to the input coordinates.
+		//! \param index is the position of the Object in the store.
+		//! \param coords_dest is the Coords struct that designates the destination coordinates.
+		//! \param image_shift is the periodic image shift of the move, which is calculated by the Lattice calculateImageShift function.
+		void moveObject(const int64_t index, const Coords& coords_dest, const Coords& image_shift);
+
+		//! \brief Removes the input Object from the store.
+		//! \details The following entries are shifted to keep the order of the store, and their saved positions are updated.
+		//! \param object_ptr is the pointer to the Object to be removed.
+		void removeObject(Object* object_ptr);
+
+		//! \brief Removes multiple objects from the store in one pass over the store.
+		//! \param input_ptrs is the vector of pointers to the objects to be removed.
+		void removeObjects(const std::vector<Object*>& input_ptrs);
+
+		//! \brief Reserves memory for the input number of objects.
+		void reserve(const size_t capacity);
+
+		//! \brief Sets the index of the next mean squared displacement sample time of the object at the input position of the store.
+		void setSampleIndex(const int64_t index, const int sample_index);
+
+		//! Gets the number of objects in the store.
+		int64_t size() const;
+
+		//! \brief Copies the current state of the input Object into its entry in the store.
+		//! \details This function is used when the coordinates or the initial coordinates of an Object are changed directly.
+		//! \param object_ptr is the pointer to the Object to be updated.
+		void updateObject(Object* object_ptr);
+
+	private:
+		std::vector<Object*> object_ptrs;
+		std::vector<int> x;
+		std::vector<int> y;
+		std::vector<int> z;
+		std::vector<int> net_x;
+		std::vector<int> net_y;
+		std::vector<int> net_z;
+		std::vector<double> creation_times;
+		std::vector<int> tags;
+		std::vector<int> sample_indices;
+
+		// Moves the entry at index_src to index_dest and updates the saved position of the Object.
+		void moveEntry(const int64_t index_src, const int64_t index_dest);
+		// Resizes all of the arrays to the input number of objects.
+		void resize(const int64_t num_objects);
+	};
+
+	inline int ObjectStore::getSampleIndex(const int64_t index) const {
+		return sample_indices[index];
+	}
+
+	inline void ObjectStore::setSampleIndex(const int64_t index, const int sample_index) {
+		sample_indices[index] = sample_index;
+	}
+
+	inline void ObjectStore::moveObject(const int64_t index, const Coords& coords_dest, const Coords& image_shift) {
+		net_x[index] += coords_dest.x - x[index] + image_shift.x;
+		net_y[index] += coords_dest.y - y[index] + image_shift.y;
+		net_z[index] += coords_dest.z - z[index] + image_shift.z;
+		x[index] = coords_dest.x;
+		y[index] = coords_dest.y;
+		z[index] = coords_dest.z;
+	}
+
+}
+
+#endif // KMC_LATTICE_OBJECTSTORE_H
@@ -26,6 +26,22 @@ namespace KMC_Lattice {
 			cout << "Error! The lattice unit size must be greater than zero." << endl;
 			return false;
 		}
+		if (Enable_sparse_storage && Enable_free_site_index) {
+			cout << "Error! The sparse storage mode and the free site index cannot both be enabled." << endl;
+			return false;
+		}
+		if (Enable_sparse_storage && Enable_neighbor_counts) {
+			cout << "Error! The sparse storage mode and the neighbor counts cannot both be enabled." << endl;
+			return false;
+		}
+		if (Enable_sparse_storage && Enable_site_states) {
+			cout << "Error! The sparse storage mode and the site states cannot both be enabled." << endl;
+			return false;
+		}
+		if (Enable_sparse_storage && Enable_site_energies) {
+			cout << "Error! The sparse storage mode and the site energies cannot both be enabled." << endl;
+			return false;
+		}
 		return true;
 	}
 
@@ -31,6 +31,22 @@ namespace KMC_Lattice {
 		int Height = 0;
 		//! Defines the desired lattice unit size, which is used to convert lattice units into real space units.
 		double Unit_size = 0.0; // nm
+		//! Determines whether the lattice will maintain an index of the unoccupied sites, which allows random unoccupied sites to be chosen
+		//! in constant time at any occupancy at the cost of extra memory.
+		bool Enable_free_site_index = false;
+		//! Determines whether the lattice will store only the occupied sites and the lazily created site objects in a hash map,
+		//! so that the memory usage scales with the number of occupied sites instead of the lattice volume.
+		//! The sparse storage mode cannot be combined with the free site index, the neighbor counts, the site states, or the site energies.
+		bool Enable_sparse_storage = false;
+		//! Determines whether the lattice will keep track of the number of occupied nearest neighbors of every site, so that
+		//! the coordination of a site can be determined without checking the occupancy of each neighbor.
+		bool Enable_neighbor_counts = false;
+		//! Determines whether the lattice will store a compact site type code and occupant species code for every site,
+		//! which can be used by rate calculations without accessing the Site objects.
+		bool Enable_site_states = false;
+		//! Determines whether the lattice will store a contiguous array of site energies, which can be filled using the
+		//! density of states generator functions and used for batched energy difference calculations.
+		bool Enable_site_energies = false;
 
 		// Functions
 		//! Default virtual destructor.
@@ -47,6 +47,18 @@ namespace KMC_Lattice {
 			cout << "Error! The event recalculation cutoff radius must be greater than zero." << endl;
 			return false;
 		}
+		if (Enable_msd_accumulator && !(MSD_time_min > 0)) {
+			cout << "Error! The first mean squared displacement sample time must be greater than zero." << endl;
+			return false;
+		}
+		if (Enable_msd_accumulator && !(MSD_time_max >= MSD_time_min)) {
+			cout << "Error! The largest mean squared displacement sample time must not be less than the first sample time." << endl;
+			return false;
+		}
+		if (Enable_msd_accumulator && !(MSD_bins_per_decade > 0)) {
+			cout << "Error! The number of mean squared displacement sample times per decade must be greater than zero." << endl;
+			return false;
+		}
 		if (Enable_logging && Logfile == nullptr) {
 			cout << "Error! The logfile filestream has not been set." << endl;
 			return false;
@@ -7,6 +7,7 @@
 #define KMC_LATTICE_PARAMETERS_SIMULATION_H
 
 #include "Parameters_Lattice.h"
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 
@@ -32,6 +33,19 @@ namespace KMC_Lattice {
 		int Recalc_cutoff = 0;
 		//! Determines whether the full recalculation method will be used or not.
 		bool Enable_full_recalc = false;
+		//! \brief Defines the seed of the simulation run, where a value of zero selects a seed from the current time.
+		//! \details The random number generator and the counter-based random number streams of each processor are seeded with a key
+		//! that is calculated from this seed and the processor ID number, so that a run with a set seed can be reproduced exactly.
+		uint64_t Random_seed = 0;
+		//! \brief Determines whether the mean squared displacement of the objects will be accumulated during the simulation or not.
+		//! \details When enabled, the displacement of each object is recorded at logarithmically spaced times after its creation using the MSDAccumulator class.
+		bool Enable_msd_accumulator = false;
+		//! Defines the first mean squared displacement sample time in seconds.
+		double MSD_time_min = 0.0;
+		//! Defines the largest allowed mean squared displacement sample time in seconds.
+		double MSD_time_max = 0.0;
+		//! Defines the number of mean squared displacement sample times in each factor of ten in time.
+		int MSD_bins_per_decade = 0;
 		//! Defines the desired output file stream pointer to the logfile.
 		std::ofstream* Logfile = nullptr;
 
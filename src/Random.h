@@ -0,0 +1,708 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software package.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#ifndef KMC_LATTICE_RANDOM_H
+#define KMC_LATTICE_RANDOM_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace KMC_Lattice {
+
+	//! \brief Calculates the upper 64 bits of the 128-bit product of two 64-bit numbers.
+	//! \details Compiler support for 128-bit integers is used when it is available, and otherwise the product is calculated from 32-bit parts.
+	uint64_t calculateMultiplyHigh(const uint64_t a, const uint64_t b);
+
+	//! \brief Generates a 32-bit random number from the input engine.
+	//! \details Engines that produce 64-bit random numbers provide the upper 32 bits of their output.
+	//! \param gen is the random number generator engine, which must produce random numbers with a range of at least 32 bits.
+	template<typename Engine>
+	uint32_t generateBits32(Engine& gen);
+
+	//! \brief Generates a 64-bit random number from the input engine.
+	//! \details Engines that produce 32-bit random numbers are called twice, where the first number provides the upper 32 bits.
+	//! \param gen is the random number generator engine, which must produce random numbers with a range of at least 32 bits.
+	template<typename Engine>
+	uint64_t generateBits64(Engine& gen);
+
+	//! \brief Fills an array with uniform random numbers in the range (0,1].
+	//! \details Each number is calculated from the upper 53 bits of a 64-bit random number. The random bits are generated in 
+	//! blocks and then converted to doubles in a separate loop, so that the conversion can be vectorized by the compiler.
+	//! For the Philox4x32 engine, the results are the same as calling the Philox4x32::convertToDouble function on consecutive pairs of outputs.
+	//! \param gen is the random number generator engine.
+	//! \param output is the array where the random numbers will be placed.
+	//! \param count is the number of random numbers to be generated.
+	template<typename Engine>
+	void generateUniform01(Engine& gen, double* output, const size_t count);
+
+	//! \brief This class generates uniformly distributed random integers from 0 to a fixed range minus one.
+	//! \details The integers are generated with Lemire's multiply-shift method, which maps a random number to the range with one
+	//! multiplication instead of a division and only rejects a small number of the random numbers to remove the bias. The rejection threshold
+	//! is calculated once when the range is set, so generating integers with a fixed range does not require any divisions. The static version
+	//! of the generate function is used when the range changes on every call, which calculates the threshold only in the rare case that it is needed.
+	//! The method is described in D. Lemire, ACM Trans. Model. Comput. Simul. 29, 3 (2019).
+	//! This version of the class uses 32-bit random numbers, which is used for ranges up to 2^32.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class BoundedSampler32 {
+	public:
+		//! Default constructor that creates a sampler with a range of one, which always generates zero.
+		BoundedSampler32();
+
+		//! \brief Constructs a sampler with the input range.
+		//! \param range is the number of possible integers, which must be at least one.
+		BoundedSampler32(const uint32_t range);
+
+		//! \brief Generates a random integer from 0 to the range minus one.
+		//! \param gen is the random number generator engine.
+		template<typename Engine>
+		uint32_t generate(Engine& gen) const;
+
+		//! \brief Generates a random integer from 0 to the input range minus one.
+		//! \param gen is the random number generator engine.
+		//! \param range is the number of possible integers, which must be at least one.
+		template<typename Engine>
+		static uint32_t generate(Engine& gen, const uint32_t range);
+
+		//! Gets the range of the sampler.
+		uint32_t getRange() const;
+
+		//! \brief Sets the range of the sampler and calculates the rejection threshold.
+		//! \param range is the number of possible integers, which must be at least one.
+		void setRange(const uint32_t range);
+
+	private:
+		uint32_t Range;
+		uint32_t Threshold;
+	};
+
+	//! \brief This class generates uniformly distributed random integers from 0 to a fixed range minus one.
+	//! \details This version of the BoundedSampler32 class uses 64-bit random numbers and the upper half of the 128-bit product, 
+	//! which is used for ranges that can be larger than 2^32, such as site indices of very large lattices.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class BoundedSampler64 {
+	public:
+		//! Default constructor that creates a sampler with a range of one, which always generates zero.
+		BoundedSampler64();
+
+		//! \brief Constructs a sampler with the input range.
+		//! \param range is the number of possible integers, which must be at least one.
+		BoundedSampler64(const uint64_t range);
+
+		//! \brief Generates a random integer from 0 to the range minus one.
+		//! \param gen is the random number generator engine.
+		template<typename Engine>
+		uint64_t generate(Engine& gen) const;
+
+		//! \brief Generates a random integer from 0 to the input range minus one.
+		//! \param gen is the random number generator engine.
+		//! \param range is the number of possible integers, which must be at least one.
+		template<typename Engine>
+		static uint64_t generate(Engine& gen, const uint64_t range);
+
+		//! Gets the range of the sampler.
+		uint64_t getRange() const;
+
+		//! \brief Sets the range of the sampler and calculates the rejection threshold.
+		//! \param range is the number of possible integers, which must be at least one.
+		void setRange(const uint64_t range);
+
+	private:
+		uint64_t Range;
+		uint64_t Threshold;
+	};
+
+	//! \brief This class implements the PCG64 random number generator with a 128-bit linear congruential state and the XSL RR output function.
+	//! \details The generator has a 32 byte state and passes the common statistical test suites. The 128-bit arithmetic is implemented
+	//! with 64-bit words, so the class does not require compiler support for 128-bit integers.
+	//! The algorithm is described in M. E. O'Neill, Harvey Mudd College Technical Report HMC-CS-2014-0905 (2014).
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class Pcg64 {
+	public:
+		//! The type of the random numbers produced by the generator.
+		typedef uint64_t result_type;
+
+		//! Default constructor that creates a generator with a seed of zero.
+		Pcg64();
+
+		//! \brief Constructs a generator with the input seed and the default stream.
+		//! \param seed is the seed, which sets the initial state.
+		Pcg64(const uint64_t seed);
+
+		//! \brief Constructs a generator with the input seed and stream number.
+		//! \param seed is the seed, which sets the initial state.
+		//! \param stream is the stream number, which sets the increment of the linear congruential generator.
+		Pcg64(const uint64_t seed, const uint64_t stream);
+
+		//! Gets the largest number that can be produced by the generator.
+		static constexpr result_type max() { return 0xFFFFFFFFFFFFFFFFULL; }
+
+		//! Gets the smallest number that can be produced by the generator.
+		static constexpr result_type min() { return 0ULL; }
+
+		//! \brief Resets the generator with the input seed and the default stream.
+		//! \param seed is the seed, which sets the initial state.
+		void seed(const uint64_t seed);
+
+		//! \brief Resets the generator with the input seed and stream number.
+		//! \details The seeding procedure matches the reference implementation, so the same seed and stream produce the same sequence.
+		//! \param seed is the seed, which sets the initial state.
+		//! \param stream is the stream number, which sets the increment of the linear congruential generator.
+		void seed(const uint64_t seed, const uint64_t stream);
+
+		//! Generates the next random number in the sequence.
+		result_type operator()();
+
+	private:
+		uint64_t State_high;
+		uint64_t State_low;
+		uint64_t Increment_high;
+		uint64_t Increment_low;
+
+		// Sets the initial state from the seed using the current increment.
+		void initializeState(const uint64_t seed);
+
+		// Advances the 128-bit linear congruential state by one step.
+		void step();
+	};
+
+	//! \brief This class implements the xoshiro256++ random number generator.
+	//! \details The generator has a 32 byte state and only uses additions, shifts, rotations, and exclusive ors, which makes it
+	//! one of the fastest generators that passes the common statistical test suites. The state is initialized from the seed using
+	//! the splitmix64 generator as recommended by the authors.
+	//! The algorithm is described in D. Blackman and S. Vigna, ACM Trans. Math. Softw. 47, 36 (2021).
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class Xoshiro256pp {
+	public:
+		//! The type of the random numbers produced by the generator.
+		typedef uint64_t result_type;
+
+		//! Default constructor that creates a generator with a seed of zero.
+		Xoshiro256pp();
+
+		//! \brief Constructs a generator with the input seed.
+		//! \param seed is the seed, which is expanded into the initial state using the splitmix64 generator.
+		Xoshiro256pp(const uint64_t seed);
+
+		//! \brief Calculates the next output of the splitmix64 generator and advances its state.
+		//! \param state is the state of the splitmix64 generator.
+		static uint64_t calculateSplitMix64(uint64_t& state);
+
+		//! Gets the largest number that can be produced by the generator.
+		static constexpr result_type max() { return 0xFFFFFFFFFFFFFFFFULL; }
+
+		//! Gets the smallest number that can be produced by the generator.
+		static constexpr result_type min() { return 0ULL; }
+
+		//! \brief Resets the generator with the input seed.
+		//! \param seed is the seed, which is expanded into the initial state using the splitmix64 generator.
+		void seed(const uint64_t seed);
+
+		//! Generates the next random number in the sequence.
+		result_type operator()();
+
+	private:
+		uint64_t State[4];
+	};
+
+	//! \brief This class implements the Philox4x32-10 counter-based random number generator.
+	//! \details Counter-based generators calculate each block of four 32-bit random numbers directly from a 128-bit counter and
+	//! a 64-bit key, so any element of the random sequence can be generated without generating the preceding elements. This allows
+	//! large arrays to be filled in parallel with results that do not depend on the number of threads, by using the array index as
+	//! the counter. The class also satisfies the requirements of a uniform random bit generator, so it can be used as an engine
+	//! with the standard library distributions, where the stream number selects one of 2^64 independent sequences for each seed.
+	//! The algorithm is described in J. K. Salmon, M. A. Moraes, R. O. Dror, and D. E. Shaw, Proc. SC11 (2011).
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class Philox4x32 {
+	public:
+		//! The type of the random numbers produced by the generator.
+		typedef uint32_t result_type;
+
+		//! Default constructor that creates a generator with a seed of zero.
+		Philox4x32();
+
+		//! \brief Constructs a generator with the input seed and stream number.
+		//! \param seed is the seed, which is used as the key of the generator.
+		//! \param stream is the stream number, which selects an independent sequence for the same seed.
+		Philox4x32(const uint64_t seed, const uint64_t stream = 0);
+
+		//! \brief Converts two 32-bit random numbers to a double precision random number in the range (0,1].
+		//! \param high is the random number that provides the upper 32 bits of the 53-bit mantissa.
+		//! \param low is the random number that provides the lower 21 bits of the 53-bit mantissa.
+		static double convertToDouble(const uint32_t high, const uint32_t low);
+
+		//! \brief Calculates one block of four random numbers from the input counter and key.
+		//! \param counter is the array of four counter words.
+		//! \param key is the array of two key words.
+		//! \param output is the array where the four random numbers will be placed.
+		static void generateBlock(const uint32_t counter[4], const uint32_t key[2], uint32_t output[4]);
+
+		//! \brief Calculates the block of four random numbers that belongs to the input index of a seeded array.
+		//! \details This function is used to fill arrays in parallel, where each element uses its own block.
+		//! \param seed is the seed, which is used as the key.
+		//! \param index is the array index, which is used as the lower half of the counter.
+		//! \param tag is the value used as the upper half of the counter, which can be used to draw additional blocks for the same index.
+		//! \param output is the array where the four random numbers will be placed.
+		static void generateBlock(const uint64_t seed, const uint64_t index, const uint64_t tag, uint32_t output[4]);
+
+		//! Gets the largest number that can be produced by the generator.
+		static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+		//! Gets the smallest number that can be produced by the generator.
+		static constexpr result_type min() { return 0u; }
+
+		//! \brief Resets the generator with the input seed and stream number.
+		//! \param seed is the seed, which is used as the key of the generator.
+		//! \param stream is the stream number, which selects an independent sequence for the same seed.
+		void seed(const uint64_t seed, const uint64_t stream = 0);
+
+		//! Generates the next random number in the sequence.
+		result_type operator()();
+
+	private:
+		uint32_t Counter[4];
+		uint32_t Key[2];
+		uint32_t Buffer[4];
+		int Buffer_position = 4;
+	};
+
+	inline uint64_t calculateMultiplyHigh(const uint64_t a, const uint64_t b) {
+#ifdef __SIZEOF_INT128__
+		return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#else
+		uint64_t a_low = (uint32_t)a;
+		uint64_t a_high = a >> 32;
+		uint64_t b_low = (uint32_t)b;
+		uint64_t b_high = b >> 32;
+		uint64_t product_low = a_low * b_low;
+		uint64_t product_mid1 = a_low * b_high;
+		uint64_t product_mid2 = a_high * b_low;
+		uint64_t carry = ((product_low >> 32) + (uint32_t)product_mid1 + (uint32_t)product_mid2) >> 32;
+		return a_high * b_high + (product_mid1 >> 32) + (product_mid2 >> 32) + carry;
+#endif
+	}
+
+	inline BoundedSampler32::BoundedSampler32() {
+		setRange(1);
+	}
+
+	inline BoundedSampler32::BoundedSampler32(const uint32_t range) {
+		setRange(range);
+	}
+
+	template<typename Engine>
+	inline uint32_t BoundedSampler32::generate(Engine& gen) const {
+		uint64_t product = (uint64_t)generateBits32(gen) * Range;
+		while ((uint32_t)product < Threshold) {
+			product = (uint64_t)generateBits32(gen) * Range;
+		}
+		return (uint32_t)(product >> 32);
+	}
+
+	template<typename Engine>
+	inline uint32_t BoundedSampler32::generate(Engine& gen, const uint32_t range) {
+		uint64_t product = (uint64_t)generateBits32(gen) * range;
+		// The threshold is only needed when the lower half of the product is smaller than the range
+		if ((uint32_t)product < range) {
+			uint32_t threshold = (uint32_t)(-range) % range;
+			while ((uint32_t)product < threshold) {
+				product = (uint64_t)generateBits32(gen) * range;
+			}
+		}
+		return (uint32_t)(product >> 32);
+	}
+
+	inline uint32_t BoundedSampler32::getRange() const {
+		return Range;
+	}
+
+	inline void BoundedSampler32::setRange(const uint32_t range) {
+		Range = range;
+		// Number of lower product values that must be rejected, which is 2^32 mod range
+		Threshold = (uint32_t)(-range) % range;
+	}
+
+	inline BoundedSampler64::BoundedSampler64() {
+		setRange(1);
+	}
+
+	inline BoundedSampler64::BoundedSampler64(const uint64_t range) {
+		setRange(range);
+	}
+
+	template<typename Engine>
+	inline uint64_t BoundedSampler64::generate(Engine& gen) const {
+		uint64_t bits = generateBits64(gen);
+		while (bits * Range < Threshold) {
+			bits = generateBits64(gen);
+		}
+		return calculateMultiplyHigh(bits, Range);
+	}
+
+	template<typename Engine>
+	inline uint64_t BoundedSampler64::generate(Engine& gen, const uint64_t range) {
+		uint64_t bits = generateBits64(gen);
+		if (bits * range < range) {
+			uint64_t threshold = (uint64_t)(-range) % range;
+			while (bits * range < threshold) {
+				bits = generateBits64(gen);
+			}
+		}
+		return calculateMultiplyHigh(bits, range);
+	}
+
+	inline uint64_t BoundedSampler64::getRange() const {
+		return Range;
+	}
+
+	inline void BoundedSampler64::setRange(const uint64_t range) {
+		Range = range;
+		// Number of lower product values that must be rejected, which is 2^64 mod range
+		Threshold = (uint64_t)(-range) % range;
+	}
+
+	inline Pcg64::Pcg64() {
+		seed(0);
+	}
+
+	inline Pcg64::Pcg64(const uint64_t seed_in) {
+		seed(seed_in);
+	}
+
+	inline Pcg64::Pcg64(const uint64_t seed_in, const uint64_t stream) {
+		seed(seed_in, stream);
+	}
+
+	inline void Pcg64::initializeState(const uint64_t seed_in) {
+		State_high = 0;
+		State_low = 0;
+		step();
+		State_low += seed_in;
+		if (State_low < seed_in) {
+			State_high++;
+		}
+		step();
+	}
+
+	inline void Pcg64::seed(const uint64_t seed_in) {
+		Increment_high = 0x5851F42D4C957F2DULL;
+		Increment_low = 0x14057B7EF767814FULL;
+		initializeState(seed_in);
+	}
+
+	inline void Pcg64::seed(const uint64_t seed_in, const uint64_t stream) {
+		// The increment must be odd, so the stream number is shifted into the upper 127 bits
+		Increment_high = stream >> 63;
+		Increment_low = (stream << 1) | 1ULL;
+		initializeState(seed_in);
+	}
+
+	inline void Pcg64::step() {
+		const uint64_t multiplier_high = 0x2360ED051FC65DA4ULL;
+		const uint64_t multiplier_low = 0x4385DF649FCCF645ULL;
+		// 128-bit multiplication modulo 2^128 followed by the 128-bit addition of the increment
+		uint64_t high = calculateMultiplyHigh(State_low, multiplier_low) + State_high * multiplier_low + State_low * multiplier_high;
+		uint64_t low = State_low * multiplier_low;
+		State_low = low + Increment_low;
+		State_high = high + Increment_high + ((State_low < low) ? 1 : 0);
+	}
+
+	inline Pcg64::result_type Pcg64::operator()() {
+		step();
+		uint64_t value = State_high ^ State_low;
+		unsigned int rotation = (unsigned int)(State_high >> 58);
+		return (value >> rotation) | (value << ((64 - rotation) & 63));
+	}
+
+	inline Xoshiro256pp::Xoshiro256pp() {
+		seed(0);
+	}
+
+	inline Xoshiro256pp::Xoshiro256pp(const uint64_t seed_in) {
+		seed(seed_in);
+	}
+
+	inline uint64_t Xoshiro256pp::calculateSplitMix64(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	inline void Xoshiro256pp::seed(const uint64_t seed_in) {
+		uint64_t state = seed_in;
+		for (auto &item : State) {
+			item = calculateSplitMix64(state);
+		}
+	}
+
+	inline Xoshiro256pp::result_type Xoshiro256pp::operator()() {
+		uint64_t sum = State[0] + State[3];
+		uint64_t result = ((sum << 23) | (sum >> 41)) + State[0];
+		uint64_t t = State[1] << 17;
+		State[2] ^= State[0];
+		State[3] ^= State[1];
+		State[1] ^= State[2];
+		State[0] ^= State[3];
+		State[2] ^= t;
+		State[3] = (State[3] << 45) | (State[3] >> 19);
+		return result;
+	}
+
+	inline Philox4x32::Philox4x32() {
+		seed(0, 0);
+	}
+
+	inline Philox4x32::Philox4x32(const uint64_t seed_in, const uint64_t stream) {
+		seed(seed_in, stream);
+	}
+
+	inline double Philox4x32::convertToDouble(const uint32_t high, const uint32_t low) {
+		uint64_t bits = ((uint64_t)high << 21) | (low >> 11);
+		return (double)(bits + 1) * (1.0 / 9007199254740992.0);
+	}
+
+	inline void Philox4x32::generateBlock(const uint32_t counter[4], const uint32_t key[2], uint32_t output[4]) {
+		uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+		uint32_t k0 = key[0], k1 = key[1];
+		for (int round = 0; round < 10; round++) {
+			uint64_t product0 = (uint64_t)0xD2511F53u * c0;
+			uint64_t product1 = (uint64_t)0xCD9E8D57u * c2;
+			uint32_t next0 = (uint32_t)(product1 >> 32) ^ c1 ^ k0;
+			uint32_t next2 = (uint32_t)(product0 >> 32) ^ c3 ^ k1;
+			c1 = (uint32_t)product1;
+			c3 = (uint32_t)product0;
+			c0 = next0;
+			c2 = next2;
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+		output[0] = c0;
+		output[1] = c1;
+		output[2] = c2;
+		output[3] = c3;
+	}
+
+	inline void Philox4x32::generateBlock(const uint64_t seed, const uint64_t index, const uint64_t tag, uint32_t output[4]) {
+		const uint32_t counter[4] = { (uint32_t)index, (uint32_t)(index >> 32), (uint32_t)tag, (uint32_t)(tag >> 32) };
+		const uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+		generateBlock(counter, key, output);
+	}
+
+	inline void Philox4x32::seed(const uint64_t seed_in, const uint64_t stream) {
+		Counter[0] = 0;
+		Counter[1] = 0;
+		Counter[2] = (uint32_t)stream;
+		Counter[3] = (uint32_t)(stream >> 32);
+		Key[0] = (uint32_t)seed_in;
+		Key[1] = (uint32_t)(seed_in >> 32);
+		Buffer_position = 4;
+	}
+
+	inline Philox4x32::result_type Philox4x32::operator()() {
+		if (Buffer_position == 4) {
+			generateBlock(Counter, Key, Buffer);
+			// Increment the 64-bit block number in the lower half of the counter
+			if (++Counter[0] == 0) {
+				Counter[1]++;
+			}
+			Buffer_position = 0;
+		}
+		return Buffer[Buffer_position++];
+	}
+
+	template<typename Engine>
+	inline uint32_t generateBits32(Engine& gen) {
+		static_assert(Engine::max() - Engine::min() >= 0xFFFFFFFFULL, "The random number generator engine must produce at least 32 random bits.");
+		if (Engine::max() - Engine::min() >= 0xFFFFFFFFFFFFFFFFULL) {
+			return (uint32_t)((uint64_t)(gen() - Engine::min()) >> 32);
+		}
+		return (uint32_t)(gen() - Engine::min());
+	}
+
+	template<typename Engine>
+	inline uint64_t generateBits64(Engine& gen) {
+		static_assert(Engine::max() - Engine::min() >= 0xFFFFFFFFULL, "The random number generator engine must produce at least 32 random bits.");
+		if (Engine::max() - Engine::min() >= 0xFFFFFFFFFFFFFFFFULL) {
+			return (uint64_t)(gen() - Engine::min());
+		}
+		uint64_t high = (uint64_t)(gen() - Engine::min()) & 0xFFFFFFFFULL;
+		uint64_t low = (uint64_t)(gen() - Engine::min()) & 0xFFFFFFFFULL;
+		return (high << 32) | low;
+	}
+
+	template<typename Engine>
+	inline void generateUniform01(Engine& gen, double* output, const size_t count) {
+		const size_t block_size = 64;
+		uint64_t bits[block_size];
+		for (size_t index_start = 0; index_start < count; index_start += block_size) {
+			size_t block_count = (count - index_start < block_size) ? (count - index_start) : block_size;
+			for (size_t n = 0; n < block_count; n++) {
+				bits[n] = generateBits64(gen);
+			}
+			// The 53-bit values fit in a signed integer, whose conversion to double is vectorized on more instruction sets than the unsigned conversion
+			double* block_output = output + index_start;
+			for (size_t n = 0; n < block_count; n++) {
+				block_output[n] = (double)(int64_t)((bits[n] >> 11) + 1) * (1.0 / 9007199254740992.0);
+			}
+		}
+	}
+
+	//! \brief This class implements the ziggurat method for generating exponentially distributed random numbers with a mean of one.
+	//! \details The exponential distribution is covered by 256 layers of equal area, where the bottom layer also contains the tail.
+	//! A single 64-bit random number selects the layer using its lowest 8 bits and the position in the layer using its upper 53 bits,
+	//! and about 99% of the numbers are accepted with one multiplication and one comparison. Only the remaining numbers that fall
+	//! in the wedges or the tail require the evaluation of an exponential or logarithm function.
+	//! The algorithm is described in G. Marsaglia and W. W. Tsang, J. Stat. Softw. 5, 8 (2000).
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class ZigguratExponential {
+	public:
+		//! The number of layers used by the ziggurat method.
+		static const int N_layers = 256;
+
+		//! \brief Generates an exponentially distributed random number with a mean of one.
+		//! \param gen is the random number generator engine.
+		template<typename Engine>
+		static double generate(Engine& gen);
+
+		//! \brief Fills an array with exponentially distributed random numbers with a mean of one.
+		//! \details The random bits are generated in blocks and the accepted numbers are calculated in a separate loop that can be
+		//! vectorized by the compiler. The rejected numbers are then regenerated one at a time.
+		//! \param gen is the random number generator engine.
+		//! \param output is the array where the random numbers will be placed.
+		//! \param count is the number of random numbers to be generated.
+		template<typename Engine>
+		static void generateBlock(Engine& gen, double* output, const size_t count);
+
+		//! \brief Gets the right edge of the input layer, where the edge of layer zero is the virtual edge that includes the tail area.
+		//! \param layer is the layer number from 0 to N_layers, where the edge of the last value is zero.
+		static double getLayerEdge(const int layer);
+
+	private:
+		// Right edge of the base layer that is not part of the tail
+		static constexpr double Tail_start = 7.69711747013104972;
+		// Area of each layer
+		static constexpr double Layer_area = 0.0039496598225815571993;
+
+		// Tables of the layer edges, the ratio of the next edge to the current edge, and the distribution function at the layer edges.
+		struct Tables {
+			double edges[N_layers + 1];
+			double ratios[N_layers];
+			double values[N_layers + 1];
+			Tables();
+		};
+
+		// Gets the tables, which are constructed once on the first use.
+		static const Tables& getTables();
+
+		// Tests a point that falls outside the rectangular part of a layer, sampling from the tail for layer zero.
+		// Returns true when the input number is accepted or has been replaced with a tail sample, and false when it is rejected.
+		template<typename Engine>
+		static bool sampleEdge(Engine& gen, const int layer, double& x);
+	};
+
+	inline ZigguratExponential::Tables::Tables() {
+		edges[0] = Layer_area / std::exp(-Tail_start);
+		edges[1] = Tail_start;
+		for (int i = 2; i < N_layers; i++) {
+			edges[i] = -std::log(Layer_area / edges[i - 1] + std::exp(-edges[i - 1]));
+		}
+		edges[N_layers] = 0.0;
+		for (int i = 0; i < N_layers; i++) {
+			ratios[i] = edges[i + 1] / edges[i];
+		}
+		for (int i = 0; i <= N_layers; i++) {
+			values[i] = std::exp(-edges[i]);
+		}
+	}
+
+	inline const ZigguratExponential::Tables& ZigguratExponential::getTables() {
+		static const Tables tables;
+		return tables;
+	}
+
+	inline double ZigguratExponential::getLayerEdge(const int layer) {
+		return getTables().edges[layer];
+	}
+
+	template<typename Engine>
+	inline double ZigguratExponential::generate(Engine& gen) {
+		const Tables& tables = getTables();
+		while (true) {
+			uint64_t bits = generateBits64(gen);
+			int layer = (int)(bits & (N_layers - 1));
+			double u = (double)(int64_t)(bits >> 11) * (1.0 / 9007199254740992.0);
+			double x = u * tables.edges[layer];
+			if (u < tables.ratios[layer] || sampleEdge(gen, layer, x)) {
+				return x;
+			}
+		}
+	}
+
+	template<typename Engine>
+	inline void ZigguratExponential::generateBlock(Engine& gen, double* output, const size_t count) {
+		const Tables& tables = getTables();
+		const size_t block_size = 64;
+		uint64_t bits[block_size];
+		for (size_t index_start = 0; index_start < count; index_start += block_size) {
+			size_t block_count = (count - index_start < block_size) ? (count - index_start) : block_size;
+			for (size_t n = 0; n < block_count; n++) {
+				bits[n] = generateBits64(gen);
+			}
+			double* block_output = output + index_start;
+			for (size_t n = 0; n < block_count; n++) {
+				block_output[n] = (double)(int64_t)(bits[n] >> 11) * (1.0 / 9007199254740992.0) * tables.edges[bits[n] & (N_layers - 1)];
+			}
+			// Numbers outside of the rectangular part of their layer are tested separately
+			for (size_t n = 0; n < block_count; n++) {
+				int layer = (int)(bits[n] & (N_layers - 1));
+				if (block_output[n] >= tables.edges[layer + 1] && !sampleEdge(gen, layer, block_output[n])) {
+					block_output[n] = generate(gen);
+				}
+			}
+		}
+	}
+
+	template<typename Engine>
+	inline bool ZigguratExponential::sampleEdge(Engine& gen, const int layer, double& x) {
+		const Tables& tables = getTables();
+		double u = (double)(int64_t)((generateBits64(gen) >> 11) + 1) * (1.0 / 9007199254740992.0);
+		if (layer == 0) {
+			// The exponential distribution is memoryless, so the tail is a shifted exponential distribution
+			x = Tail_start - std::log(u);
+			return true;
+		}
+		return tables.values[layer] + u * (tables.values[layer + 1] - tables.values[layer]) < std::exp(-x);
+	}
+
+	//! \brief The random number generator engine used by the Simulation and Lattice classes.
+	//! \details The engine is selected at compile time by defining one of KMC_LATTICE_RNG_XOSHIRO256PP, KMC_LATTICE_RNG_PCG64, or
+	//! KMC_LATTICE_RNG_PHILOX, and the Mersenne twister engine is used when none of them are defined.
+#if defined(KMC_LATTICE_RNG_XOSHIRO256PP)
+	typedef Xoshiro256pp RandomEngine;
+#elif defined(KMC_LATTICE_RNG_PCG64)
+	typedef Pcg64 RandomEngine;
+#elif defined(KMC_LATTICE_RNG_PHILOX)
+	typedef Philox4x32 RandomEngine;
+#else
+	typedef std::mt19937_64 RandomEngine;
+#endif
+
+}
+
+#endif // KMC_LATTICE_RANDOM_H
@@ -31,11 +31,21 @@ namespace KMC_Lattice {
 		Enable_full_recalc = params.Enable_full_recalc;
 		Recalc_cutoff_sq_lat = (int)((Recalc_cutoff / params.Params_lattice.Unit_size)*(Recalc_cutoff / params.Params_lattice.Unit_size));
 		temperature = params.Temperature;
+		// Mean squared displacement parameters
+		Enable_msd_accumulator = params.Enable_msd_accumulator;
+		msd_accumulator = MSDAccumulator();
+		if (Enable_msd_accumulator) {
+			msd_accumulator.init(params.MSD_time_min, params.MSD_time_max, params.MSD_bins_per_decade);
+		}
 		// Initialize data structures
 		lattice.init(params.Params_lattice, &generator);
 		object_ptrs.clear();
+		object_store.clear();
 		event_ptrs.clear();
-		generator.seed((int)time(0)*(id + 1));
+		Run_seed = (params.Random_seed != 0) ? params.Random_seed : (uint64_t)time(0);
+		Stream_key = calculateStreamKey(Run_seed, Id);
+		generator.seed(Stream_key);
+		resetRandomBuffers();
 		// Output files
 		Logfile = params.Logfile;
 	}
@@ -52,14 +62,41 @@ namespace KMC_Lattice {
 		object_ptr->setEventIt(--event_ptrs.end());
 		// Add new object to the object vector and link the object to the event
 		object_ptrs.push_back(object_ptr);
-		// Set occupancy of site
-		lattice.setOccupied(object_ptr->getCoords());
-		(*lattice.getSiteIt(object_ptr->getCoords()))->setObjectPtr(*(--object_ptrs.end()));
+		object_store.addObject(object_ptr);
+		// Set occupancy of site and store the site index in the object
+		int64_t site_index = lattice.getSiteIndex(object_ptr->getCoords());
+		lattice.setObjectPtr(site_index, object_ptr);
+		object_ptr->setSiteIndex(site_index);
 		// Update counters
 		N_objects_created++;
 		N_events_executed++;
 	}
 
+	void Simulation::addObjects(const vector<Object*>& input_ptrs) {
+		// Create the event list entries for all objects and link them to the objects before moving them into the event list
+		list<Event*> event_ptrs_new(input_ptrs.size(), nullptr);
+		auto event_it = event_ptrs_new.begin();
+		for (auto const &item : input_ptrs) {
+			item->setEventIt(event_it++);
+			// Set occupancy of site and store the site index in the object
+			int64_t site_index = lattice.getSiteIndex(item->getCoords());
+			lattice.setObjectPtr(site_index, item);
+			item->setSiteIndex(site_index);
+		}
+		event_ptrs.splice(event_ptrs.end(), event_ptrs_new);
+		object_ptrs.insert(object_ptrs.end(), input_ptrs.begin(), input_ptrs.end());
+		object_store.reserve(object_ptrs.size());
+		for (auto const &item : input_ptrs) {
+			object_store.addObject(item);
+		}
+		// Reserve the scratch buffers for the event recalculation
+		distances_sq_start.reserve(object_ptrs.size());
+		distances_sq_dest.reserve(object_ptrs.size());
+		// Update counters
+		N_objects_created += (long int)input_ptrs.size();
+		N_events_executed += (long int)input_ptrs.size();
+	}
+
 	list<Event*>::const_iterator Simulation::chooseNextEvent() {
 		return min_element(event_ptrs.begin(), event_ptrs.end(), [](Event* a, Event* b) {
 			return (a != nullptr && b == nullptr) || ((a != nullptr && b != nullptr) && (a->getExecutionTime() < b->getExecutionTime()));
@@ -103,11 +140,11 @@ namespace KMC_Lattice {
 			}
 		}
 		else if (Enable_selective_recalc) {
-			object_recalc_ptrs = findRecalcNeighbors(coords_start);
 			if (coords_start != coords_dest) {
-				vector<Object*> object_recalc_ptrs2 = findRecalcNeighbors(coords_dest);
-				object_recalc_ptrs.insert(object_recalc_ptrs.end(), object_recalc_ptrs2.begin(), object_recalc_ptrs2.end());
-				removeDuplicates(object_recalc_ptrs);
+				object_recalc_ptrs = findRecalcNeighbors(coords_start, coords_dest);
+			}
+			else {
+				object_recalc_ptrs = findRecalcNeighbors(coords_start);
 			}
 		}
 		else if (Enable_full_recalc) {
@@ -118,12 +155,57 @@ namespace KMC_Lattice {
 		return object_recalc_ptrs;
 	}
 
+	uint64_t Simulation::calculateStreamKey(const uint64_t run_seed, const int id) {
+		uint64_t state = run_seed;
+		// The splitmix64 output function is a bijection of its state, so different ID numbers cannot result in the same key
+		state = Xoshiro256pp::calculateSplitMix64(state) + (uint64_t)(uint32_t)id;
+		return Xoshiro256pp::calculateSplitMix64(state);
+	}
+
+	void Simulation::generateRand01Block(vector<double>& data) {
+		generateUniform01(generator, data.data(), data.size());
+	}
+
+	void Simulation::generateStreamBlock(const uint64_t tag, const uint64_t counter, uint32_t output[4]) const {
+		Philox4x32::generateBlock(Stream_key, counter, tag, output);
+	}
+
+	void Simulation::generateRandExpBlock(vector<double>& data) {
+		ZigguratExponential::generateBlock(generator, data.data(), data.size());
+	}
+
 	vector<Object*> Simulation::findRecalcNeighbors(const Coords& coords) const {
-		vector<Object*> neighbor_ptrs(object_ptrs.size());
-		auto it = copy_if(object_ptrs.begin(), object_ptrs.end(), neighbor_ptrs.begin(), [this, &coords](Object* element) {
-			return lattice.calculateLatticeDistanceSquared(coords, element->getCoords()) <= Recalc_cutoff_sq_lat;
-		});
-		neighbor_ptrs.resize(std::distance(neighbor_ptrs.begin(), it));
+		int num_objects = (int)object_store.size();
+		const vector<Object*>& store_ptrs = object_store.getObjectPtrs();
+		distances_sq_start.resize(num_objects);
+		lattice.calculateLatticeDistanceSquared(coords, object_store.getX().data(), object_store.getY().data(), object_store.getZ().data(), num_objects, distances_sq_start.data());
+		vector<Object*> neighbor_ptrs;
+		neighbor_ptrs.reserve(num_objects);
+		for (int i = 0; i < num_objects; i++) {
+			if (distances_sq_start[i] <= Recalc_cutoff_sq_lat) {
+				neighbor_ptrs.push_back(store_ptrs[i]);
+			}
+		}
+		return neighbor_ptrs;
+	}
+
+	vector<Object*> Simulation::findRecalcNeighbors(const Coords& coords_start, const Coords& coords_dest) const {
+		int num_objects = (int)object_store.size();
+		const vector<Object*>& store_ptrs = object_store.getObjectPtrs();
+		const int* object_x = object_store.getX().data();
+		const int* object_y = object_store.getY().data();
+		const int* object_z = object_store.getZ().data();
+		distances_sq_start.resize(num_objects);
+		distances_sq_dest.resize(num_objects);
+		lattice.calculateLatticeDistanceSquared(coords_start, object_x, object_y, object_z, num_objects, distances_sq_start.data());
+		lattice.calculateLatticeDistanceSquared(coords_dest, object_x, object_y, object_z, num_objects, distances_sq_dest.data());
+		vector<Object*> neighbor_ptrs;
+		neighbor_ptrs.reserve(num_objects);
+		for (int i = 0; i < num_objects; i++) {
+			if (distances_sq_start[i] <= Recalc_cutoff_sq_lat || distances_sq_dest[i] <= Recalc_cutoff_sq_lat) {
+				neighbor_ptrs.push_back(store_ptrs[i]);
+			}
+		}
 		return neighbor_ptrs;
 	}
 
@@ -157,6 +239,14 @@ namespace KMC_Lattice {
 		return Id;
 	}
 
+	uint64_t Simulation::getRunSeed() const {
+		return Run_seed;
+	}
+
+	uint64_t Simulation::getStreamKey() const {
+		return Stream_key;
+	}
+
 	int Simulation::getN_events() const {
 		return (int)count_if(event_ptrs.begin(), event_ptrs.end(), [](Event* element) {
 			return (element != nullptr && element->getExecutionTime() > 0);
@@ -171,6 +261,19 @@ namespace KMC_Lattice {
 		return N_objects_created;
 	}
 
+	const MSDAccumulator& Simulation::getMSDAccumulator() const {
+		return msd_accumulator;
+	}
+
+	const ObjectStore& Simulation::getObjectStore() const {
+		return object_store;
+	}
+
+	int64_t Simulation::getObjectSiteIndex(const Object* object_ptr) const {
+		int64_t site_index = object_ptr->getSiteIndex();
+		return (site_index >= 0) ? site_index : lattice.getSiteIndex(object_ptr->getCoords());
+	}
+
 	int Simulation::getTemp() const {
 		return temperature;
 	}
@@ -188,24 +291,47 @@ namespace KMC_Lattice {
 	}
 
 	void Simulation::moveObject(Object* object_ptr, const Coords& coords_dest) {
-		Coords coords_initial = object_ptr->getCoords();
-		// Clear occupancy of initial site
-		lattice.clearOccupancy(coords_initial);
-		// Check for periodic boundary crossing
-		object_ptr->incrementDX(-lattice.calculateDX(coords_initial, coords_dest));
-		object_ptr->incrementDY(-lattice.calculateDY(coords_initial, coords_dest));
-		object_ptr->incrementDZ(-lattice.calculateDZ(coords_initial, coords_dest));
-		// Set object coords to new site
-		object_ptr->setCoords(coords_dest);
-		// Set occupancy of new site
-		lattice.setOccupied(coords_dest);
-		(*lattice.getSiteIt(coords_dest))->setObjectPtr(object_ptr);
+		moveObject(object_ptr, coords_dest, lattice.getSiteIndex(coords_dest));
+	}
+
+	void Simulation::moveObject(Object* object_ptr, const int64_t site_index_dest) {
+		moveObject(object_ptr, lattice.getSiteCoords(site_index_dest), site_index_dest);
+	}
+
+	void Simulation::moveObject(Object* object_ptr, const Coords& coords_dest, const int64_t site_index_dest) {
+		// Find the store entry of the object before anything is changed
+		int64_t store_index = object_store.checkObject(object_ptr);
+		// Move the occupancy and occupant species code from the initial site to the new site
+		lattice.moveOccupant(getObjectSiteIndex(object_ptr), site_index_dest, object_ptr);
+		// Set object coords to new site and account for any periodic boundary crossing
+		Coords image_shift = lattice.calculateImageShift(object_ptr->getCoords(), coords_dest);
+		// Record the displacement at the sample times that have passed while the object was at its initial site
+		if (Enable_msd_accumulator) {
+			recordMSDSamples(store_index);
+		}
+		object_store.moveObject(store_index, coords_dest, image_shift);
+		object_ptr->moveTo(coords_dest, site_index_dest, image_shift);
 		// Update counter
 		N_events_executed++;
 	}
 
-	double Simulation::rand01() {
-		return generate_canonical<double, std::numeric_limits<double>::digits>(generator);
+	double Simulation::rand01(Object* object_ptr) const {
+		uint32_t block[4];
+		generateStreamBlock((uint64_t)(int64_t)object_ptr->getTag(), object_ptr->getRandomCounter(), block);
+		object_ptr->incrementRandomCounter();
+		return Philox4x32::convertToDouble(block[0], block[1]);
+	}
+
+	void Simulation::refillRand01Buffer() {
+		rand01_buffer.resize(Random_block_size);
+		generateUniform01(generator, rand01_buffer.data(), rand01_buffer.size());
+		Rand01_index = 0;
+	}
+
+	void Simulation::refillRandExpBuffer() {
+		rand_exp_buffer.resize(Random_block_size);
+		ZigguratExponential::generateBlock(generator, rand_exp_buffer.data(), rand_exp_buffer.size());
+		Rand_exp_index = 0;
 	}
 
 	void Simulation::removeEvent(Event* event_ptr) {
@@ -224,12 +350,17 @@ namespace KMC_Lattice {
 		// Find the Object pointer
 		auto it = find_if(object_ptrs.begin(), object_ptrs.end(), [object_ptr](Object* element) {return element == object_ptr; });
 		if (it != object_ptrs.end()) {
+			int64_t store_index = object_store.checkObject(object_ptr);
 			// Clear occupancy of site
-			lattice.clearOccupancy(object_ptr->getCoords());
+			lattice.clearOccupancy(getObjectSiteIndex(object_ptr));
 			// Delete the corresponding Event pointer
 			event_ptrs.erase(object_ptr->getEventIt());
 			// Delete the Object pointer
 			object_ptrs.erase(it);
+			if (Enable_msd_accumulator) {
+				recordMSDSamples(store_index);
+			}
+			object_store.removeObject(object_ptr);
 		}
 		else {
 			cout << "Error! The Object pointer could not be found in the object list and could not be removed." << endl;
@@ -239,6 +370,55 @@ namespace KMC_Lattice {
 		N_events_executed++;
 	}
 
+	void Simulation::removeAllObjects() {
+		updateMSDAccumulator();
+		for (auto const &item : object_ptrs) {
+			// Clear occupancy of site
+			lattice.clearOccupancy(getObjectSiteIndex(item));
+			// Delete the corresponding Event pointer
+			event_ptrs.erase(item->getEventIt());
+		}
+		// Update counters
+		N_events_executed += (long int)object_ptrs.size();
+		object_ptrs.clear();
+		object_store.clear();
+	}
+
+	void Simulation::removeObjects(const vector<Object*>& input_ptrs) {
+		unordered_set<Object*> remove_set(input_ptrs.begin(), input_ptrs.end());
+		vector<Object*> removed_ptrs;
+		removed_ptrs.reserve(remove_set.size());
+		object_ptrs.remove_if([this, &remove_set, &removed_ptrs](Object* element) {
+			if (remove_set.count(element) == 0) {
+				return false;
+			}
+			int64_t store_index = object_store.checkObject(element);
+			// Clear occupancy of site
+			lattice.clearOccupancy(getObjectSiteIndex(element));
+			// Delete the corresponding Event pointer
+			event_ptrs.erase(element->getEventIt());
+			if (Enable_msd_accumulator) {
+				recordMSDSamples(store_index);
+			}
+			removed_ptrs.push_back(element);
+			return true;
+		});
+		object_store.removeObjects(removed_ptrs);
+		if (removed_ptrs.size() != remove_set.size()) {
+			cout << "Error! " << remove_set.size() - removed_ptrs.size() << " of the Object pointers could not be found in the object list and could not be removed." << endl;
+			Error_found = true;
+		}
+		// Update counters
+		N_events_executed += (long int)removed_ptrs.size();
+	}
+
+	void Simulation::resetRandomBuffers() {
+		rand01_buffer.clear();
+		Rand01_index = 0;
+		rand_exp_buffer.clear();
+		Rand_exp_index = 0;
+	}
+
 	void Simulation::setErrorMessage(const string& input_msg) {
 		error_msg = input_msg;
 	}
@@ -248,11 +428,27 @@ namespace KMC_Lattice {
 	}
 
 	void Simulation::setGeneratorSeed(int seed) {
-		generator.seed(seed);
+		Run_seed = (uint64_t)seed;
+		Stream_key = calculateStreamKey(Run_seed, Id);
+		generator.seed(Stream_key);
+		resetRandomBuffers();
 	}
 
 	void Simulation::setTime(const double new_time) {
 		time_sim = new_time;
 	}
 
+	void Simulation::updateObjectStore(Object* object_ptr) {
+		object_store.updateObject(object_ptr);
+	}
+
+	void Simulation::updateMSDAccumulator() {
+		if (!Enable_msd_accumulator) {
+			return;
+		}
+		for (int64_t i = 0; i < object_store.size(); i++) {
+			recordMSDSamples(i);
+		}
+	}
+
 }
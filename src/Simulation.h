@@ -8,7 +8,9 @@
 
 #include "Utils.h"
 #include "Lattice.h"
+#include "MSDAccumulator.h"
 #include "Object.h"
+#include "ObjectStore.h"
 #include "Parameters_Simulation.h"
 #include "Event.h"
 #include <list>
@@ -20,6 +22,7 @@
 #include <ctime>
 #include <numeric>
 #include <algorithm>
+#include <unordered_set>
 
 namespace KMC_Lattice {
 
@@ -76,6 +79,24 @@ namespace KMC_Lattice {
 		//! Gets the number of objects that have been created in the simulation.
 		long int getN_objects_created() const;
 
+		//! \brief Gets the MSDAccumulator that contains the mean squared displacement samples of the objects.
+		//! \details The samples are only recorded when the Enable_msd_accumulator parameter is enabled. The displacement of each object is recorded
+		//! when it is moved or removed, so the updateMSDAccumulator function should be called at the end of the simulation to record the samples
+		//! of the remaining objects.
+		const MSDAccumulator& getMSDAccumulator() const;
+
+		//! \brief Gets the ObjectStore that contains the state of all objects in the simulation in a structure-of-arrays layout.
+		//! \details The store is updated when objects are added, moved, and removed using the Simulation functions, and it can be used 
+		//! to calculate quantities over all objects, such as the mean squared displacement, without following a pointer to each Object.
+		const ObjectStore& getObjectStore() const;
+
+		//! \brief Gets the seed of the simulation run.
+		//! \details The seed is set by the Random_seed parameter or the setGeneratorSeed function, or it is selected from the current time.
+		uint64_t getRunSeed() const;
+
+		//! \brief Gets the key of the counter-based random number streams, which is calculated from the run seed and the processor ID number.
+		uint64_t getStreamKey() const;
+
 		//! \brief Gets the processor ID number for the processor that is running the simulation.
 		//! \details This is primarily used with MPI to differentiate between different simulations running on 
 		//! different cores.
@@ -96,16 +117,63 @@ namespace KMC_Lattice {
 		//! \return false if logging is disabled.
 		bool isLoggingEnabled() const;
 
-		//! Generates a uniform random number from 0 to 1, not including 0.
+		//! \brief Fills the input data vector with uniform random numbers from 0 to 1, not including 0.
+		//! \details This function is intended for callers that need many random numbers at once, such as the batched recalculation of 
+		//! event rates. The numbers are drawn directly from the generator in blocks, so the data vector does not affect the buffered 
+		//! random numbers returned by the rand01 function.
+		//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
+		void generateRand01Block(std::vector<double>& data);
+
+		//! \brief Calculates the key of the counter-based random number streams from the input run seed and processor ID number.
+		//! \details The seed and ID number are combined with two rounds of the splitmix64 mixing function, so processors that
+		//! are started with the same or consecutive seeds use unrelated keys, and different ID numbers always result in different keys.
+		//! \param run_seed is the seed of the simulation run.
+		//! \param id is the processor ID number.
+		static uint64_t calculateStreamKey(const uint64_t run_seed, const int id);
+
+		//! \brief Calculates a block of four random numbers from the counter-based random number stream with the input tag and counter.
+		//! \details The block is calculated with the Philox4x32 generator using the stream key as the key and the tag and counter
+		//! as the counter, so the result only depends on the run seed, the processor ID number, the tag, and the counter. The function
+		//! does not modify the simulation, so it can be called from multiple threads.
+		//! \param tag is the number that identifies the stream, such as the tag id number of an Object.
+		//! \param counter is the position in the stream.
+		//! \param output is the array where the four random numbers will be placed.
+		void generateStreamBlock(const uint64_t tag, const uint64_t counter, uint32_t output[4]) const;
+
+		//! \brief Fills the input data vector with exponentially distributed random numbers with a mean of one.
+		//! \details This function is intended for callers that need many random numbers at once, such as the batched calculation of 
+		//! event execution times. The numbers are drawn directly from the generator using the ZigguratExponential class, so the data 
+		//! vector does not affect the buffered random numbers returned by the randExp function.
+		//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
+		void generateRandExpBlock(std::vector<double>& data);
+
+		//! \brief Generates a uniform random number from 0 to 1, not including 0.
+		//! \details The random numbers are taken from an internal buffer, which is refilled in blocks using the generateUniform01 function when it is empty.
 		double rand01();
 
+		//! \brief Generates a uniform random number from 0 to 1, not including 0, from the counter-based random number stream of the input Object.
+		//! \details The stream is selected by the tag id number of the Object, and the random counter of the Object is incremented, 
+		//! so the random numbers drawn by each Object do not depend on the order in which the objects draw them or on the thread that is used.
+		//! \param object_ptr is the pointer to the Object whose stream is used.
+		double rand01(Object* object_ptr) const;
+
+		//! \brief Generates an exponentially distributed random number with a mean of one.
+		//! \details The random numbers have the same distribution as -log(rand01()), but they are generated using the ziggurat method, which avoids
+		//! the logarithm for almost all numbers. The random numbers are taken from an internal buffer, which is refilled in blocks when it is empty.
+		double randExp();
+
+		//! \brief Records the displacement of all objects in the MSDAccumulator for the sample times that have passed since their previous moves.
+		//! \details This function does nothing when the Enable_msd_accumulator parameter is disabled.
+		void updateMSDAccumulator();
+
 		//! \brief Sets the random number generator seed.
-		//! \details This is primarily used for testing with a set starting seed.
+		//! \details This is primarily used for testing with a set starting seed. The input seed becomes the run seed, and the generator
+		//! is seeded with the stream key calculated from the run seed and the processor ID number.
 		void setGeneratorSeed(const int seed);
 
 	protected:
-		//! Mersenne Twister random number generator
-		std::mt19937_64 generator;
+		//! Random number generator engine, which is selected at compile time as described for the RandomEngine type.
+		RandomEngine generator;
 		//! Pointer to an output file stream that is used to print log messages to a logfile when logging is enabled.
 		std::ofstream* Logfile;
 		//! The Lattice object represents a three-dimensional lattice, its boundary conditions, and its occupancy.
@@ -126,6 +194,13 @@ namespace KMC_Lattice {
 		//! \param object_ptr is the input Object pointer.
 		void addObject(Object* object_ptr);
 
+		//! \brief Adds pointers to multiple Object objects to the object list in one pass.
+		//! \details This function has the same effect as calling the addObject function for each input Object pointer, but the
+		//! event list entries are created together and spliced into the event list, and the scratch buffers used for the event
+		//! recalculation are reserved for the new number of objects. It is intended for seeding large numbers of initial objects.
+		//! \param input_ptrs is the vector of input Object pointers.
+		void addObjects(const std::vector<Object*>& input_ptrs);
+
 		//! \brief Searches the event list and determines which event will be executed next.
 		//! \details Chooses the event that has the smallest execution time.
 		//! \return A list iterator points to an Event pointer in event list that has been selected to be executed next.
@@ -148,10 +223,25 @@ namespace KMC_Lattice {
 		std::vector<Object*> getAllObjectPtrs() const;
 
 		//! \brief Moves the designated object to the designated destination coordinates.
+		//! \details When the lattice site states are enabled, the occupant species code of the initial site is moved to the destination site.
 		//! \param object_ptr is an Object pointer to the object that is to be moved.
 		//! \param coords_dest is the Coords struct that designates the coordinates where the object is to be moved.
 		void moveObject(Object* object_ptr, const Coords& coords_dest);
 
+		//! \brief Moves the designated object to the site with the designated site index.
+		//! \details The destination coordinates are calculated from the site index, because they are needed to track the periodic boundary crossings.
+		//! \param object_ptr is an Object pointer to the object that is to be moved.
+		//! \param site_index_dest is the vector index of the site where the object is to be moved.
+		void moveObject(Object* object_ptr, const int64_t site_index_dest);
+
+		//! \brief Moves the designated object to the designated destination coordinates and site index.
+		//! \details This version of the function is used when both the coordinates and the site index of the destination are
+		//! already known, such as when they are stored in an Event, so that neither one needs to be recalculated.
+		//! \param object_ptr is an Object pointer to the object that is to be moved.
+		//! \param coords_dest is the Coords struct that designates the coordinates where the object is to be moved.
+		//! \param site_index_dest is the vector index of the site with the destination coordinates.
+		void moveObject(Object* object_ptr, const Coords& coords_dest, const int64_t site_index_dest);
+
 		//! \brief Removes an Event pointer from the event list.
 		//! \details The Event objects are allocated and maintained by the derived Simulation class and only the Event 
 		//! pointers are stored in the base class. Removing the Event pointer does not delete the Event from the derived
@@ -167,6 +257,17 @@ namespace KMC_Lattice {
 		//! \param object_ptr is the Object pointer to be removed from the simulation.
 		void removeObject(Object* object_ptr);
 
+		//! \brief Removes all Object pointers from the base simulation class.
+		//! \details This function has the same effect as calling the removeObject function for every Object in the simulation,
+		//! but it does not need to search the object list. It is intended for tearing down a simulation or resetting it between trials.
+		void removeAllObjects();
+
+		//! \brief Removes multiple Object pointers from the base simulation class in one pass over the object list.
+		//! \details This function has the same effect as calling the removeObject function for each input Object pointer, but the
+		//! object list is only traversed once instead of once per Object.
+		//! \param input_ptrs is the vector of Object pointers to be removed from the simulation.
+		void removeObjects(const std::vector<Object*>& input_ptrs);
+
 		//! \brief Sets the error_msg member variable to the input string.
 		//! \param input_msg is the string variable that will be saved in the error_msg member variable.
 		void setErrorMessage(const std::string& input_msg);
@@ -181,8 +282,18 @@ namespace KMC_Lattice {
 		//! \param input_time is the input time that will become the new current simulation time.
 		void setTime(const double input_time);
 
+		//! \brief Copies the current state of the designated object into the object store.
+		//! \details The object store is used to find the objects whose events need to be recalculated and to record the mean squared
+		//! displacement, so it must be updated whenever the coordinates or the initial coordinates of an Object are changed directly,
+		//! such as with the Object setCoords or resetInitialCoords functions, instead of with the moveObject functions.
+		//! \param object_ptr is an Object pointer to the object that has been changed.
+		void updateObjectStore(Object* object_ptr);
+
 	private:
-		int Id;
+		int Id = 0;
+		// Random number seeds
+		uint64_t Run_seed = 0;
+		uint64_t Stream_key = 0;
 		// General Parameters
 		bool Enable_logging;
 		int temperature; // Kelvin
@@ -192,13 +303,23 @@ namespace KMC_Lattice {
 		int Recalc_cutoff;
 		bool Enable_full_recalc;
 		int Recalc_cutoff_sq_lat;
+		// Mean Squared Displacement Parameters
+		bool Enable_msd_accumulator = false;
 		// Data Structures
 		std::list<Object*> object_ptrs;
+		ObjectStore object_store;
+		MSDAccumulator msd_accumulator;
 		std::list<Event*> event_ptrs;
 		// Counters
 		double time_sim = 0.0;
 		long int N_objects_created = 0;
 		long int N_events_executed = 0;
+		// Buffers of random numbers used by the rand01 and randExp functions
+		static const int Random_block_size = 256;
+		std::vector<double> rand01_buffer;
+		int Rand01_index = 0;
+		std::vector<double> rand_exp_buffer;
+		int Rand_exp_index = 0;
 		// Functions
 
 		//! \brief Constructs and returns a vector of pointers to all Object objects near the input coordinates within 
@@ -206,8 +327,54 @@ namespace KMC_Lattice {
 		//! \param coords is the Coords struct that designates the input coordinates.
 		//! \return a vector of Object pointers.
 		std::vector<Object*> findRecalcNeighbors(const Coords& coords) const;
+
+		//! \brief Constructs and returns a vector of pointers to all Object objects within the Recalc_cutoff radius 
+		//! of either the starting or the destination coordinates.
+		//! \details The Object coordinates are read from the structure-of-arrays ObjectStore so that the batched lattice 
+		//! distance calculation can be used, and each Object appears at most once in the output vector.
+		//! \param coords_start is the Coords struct that designates the starting coordinates.
+		//! \param coords_dest is the Coords struct that designates the destination coordinates.
+		//! \return a vector of Object pointers.
+		std::vector<Object*> findRecalcNeighbors(const Coords& coords_start, const Coords& coords_dest) const;
+
+		//! \brief Gets the site index of the input Object, which is only calculated from the coordinates when it has not been stored in the Object.
+		int64_t getObjectSiteIndex(const Object* object_ptr) const;
+
+		//! \brief Records the current displacement of the object at the input position of the object store for the sample times that have passed.
+		void recordMSDSamples(const int64_t store_index);
+
+		//! \brief Refills the buffer of uniform random numbers used by the rand01 function.
+		void refillRand01Buffer();
+
+		//! \brief Refills the buffer of exponentially distributed random numbers used by the randExp function.
+		void refillRandExpBuffer();
+
+		//! \brief Discards the remaining buffered random numbers, so that the next calls to rand01 and randExp use the current generator state.
+		void resetRandomBuffers();
+		// Scratch buffers for the batched distance calculations
+		mutable std::vector<int> distances_sq_start;
+		mutable std::vector<int> distances_sq_dest;
 	};
 
+	inline void Simulation::recordMSDSamples(const int64_t store_index) {
+		int sample_index = msd_accumulator.recordDisplacement(object_store.getSampleIndex(store_index), time_sim - object_store.getCreationTimes()[store_index], object_store.getNetX()[store_index], object_store.getNetY()[store_index], object_store.getNetZ()[store_index]);
+		object_store.setSampleIndex(store_index, sample_index);
+	}
+
+	inline double Simulation::rand01() {
+		if (Rand01_index >= (int)rand01_buffer.size()) {
+			refillRand01Buffer();
+		}
+		return rand01_buffer[Rand01_index++];
+	}
+
+	inline double Simulation::randExp() {
+		if (Rand_exp_index >= (int)rand_exp_buffer.size()) {
+			refillRandExpBuffer();
+		}
+		return rand_exp_buffer[Rand_exp_index++];
+	}
+
 }
 
 #endif // KMC_LATTICE_SIMULATION_H
@@ -0,0 +1,109 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#include "SiteHashMap.h"
+
+using namespace std;
+
+namespace KMC_Lattice {
+
+	SiteHashMap::SiteHashMap() {
+
+	}
+
+	uint64_t SiteHashMap::calculateHash(const int64_t site_index) {
+		// Finalizer of the splitmix64 generator, which spreads neighboring site indices across the whole table
+		uint64_t x = (uint64_t)site_index;
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+		return x ^ (x >> 31);
+	}
+
+	void SiteHashMap::clear() {
+		vector<Entry>().swap(slots);
+		N_entries = 0;
+		Slot_mask = 0;
+	}
+
+	void SiteHashMap::erase(const int64_t site_index) {
+		if (slots.empty()) {
+			return;
+		}
+		int64_t slot = findSlot(site_index);
+		if (slots[slot].site_index < 0) {
+			return;
+		}
+		// Backward shift deletion moves later entries of the probe sequence into the hole
+		int64_t next = (slot + 1) & Slot_mask;
+		while (slots[next].site_index >= 0) {
+			int64_t home = (int64_t)(calculateHash(slots[next].site_index) & (uint64_t)Slot_mask);
+			// Move the entry if its home slot is not cyclically located in (slot, next]
+			if (((next - home) & Slot_mask) >= ((next - slot) & Slot_mask)) {
+				slots[slot] = slots[next];
+				slot = next;
+			}
+			next = (next + 1) & Slot_mask;
+		}
+		slots[slot] = Entry();
+		N_entries--;
+	}
+
+	SiteHashMap::Entry* SiteHashMap::find(const int64_t site_index) {
+		if (slots.empty()) {
+			return nullptr;
+		}
+		int64_t slot = findSlot(site_index);
+		return (slots[slot].site_index < 0) ? nullptr : &slots[slot];
+	}
+
+	const SiteHashMap::Entry* SiteHashMap::find(const int64_t site_index) const {
+		if (slots.empty()) {
+			return nullptr;
+		}
+		int64_t slot = findSlot(site_index);
+		return (slots[slot].site_index < 0) ? nullptr : &slots[slot];
+	}
+
+	int64_t SiteHashMap::findSlot(const int64_t site_index) const {
+		int64_t slot = (int64_t)(calculateHash(site_index) & (uint64_t)Slot_mask);
+		while (slots[slot].site_index >= 0 && slots[slot].site_index != site_index) {
+			slot = (slot + 1) & Slot_mask;
+		}
+		return slot;
+	}
+
+	const vector<SiteHashMap::Entry>& SiteHashMap::getSlots() const {
+		return slots;
+	}
+
+	SiteHashMap::Entry& SiteHashMap::insert(const int64_t site_index) {
+		// Keep the load factor below 0.5 so that the probe sequences stay short
+		if (2 * (N_entries + 1) > (int64_t)slots.size()) {
+			rehash(slots.empty() ? 16 : 2 * (int64_t)slots.size());
+		}
+		int64_t slot = findSlot(site_index);
+		if (slots[slot].site_index < 0) {
+			slots[slot].site_index = site_index;
+			N_entries++;
+		}
+		return slots[slot];
+	}
+
+	void SiteHashMap::rehash(const int64_t capacity) {
+		vector<Entry> slots_old(capacity);
+		slots.swap(slots_old);
+		Slot_mask = capacity - 1;
+		for (auto const &item : slots_old) {
+			if (item.site_index >= 0) {
+				slots[findSlot(item.site_index)] = item;
+			}
+		}
+	}
+
+	int64_t SiteHashMap::size() const {
+		return N_entries;
+	}
+
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software package.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#ifndef KMC_LATTICE_SITEHASHMAP_H
+#define KMC_LATTICE_SITEHASHMAP_H
+
+#include <cstdint>
+#include <vector>
+
+namespace KMC_Lattice {
+
+	// Forward declarations of the Object and Site classes are needed by the compiler.
+	class Object;
+	class Site;
+
+	//! \brief This class implements an open addressing hash map from site indices to the occupancy state of those sites.
+	//! \details This class is used by the Lattice class to store the occupancy of a lattice in sparse storage mode, so that
+	//! the memory usage scales with the number of occupied sites instead of the lattice volume. The map uses linear probing
+	//! with backward shift deletion, so no tombstones accumulate as sites are repeatedly occupied and cleared.
+	//! \warning Pointers to entries are invalidated when a new entry is inserted or an entry is erased.
+	//! \copyright MIT License.  For more information, see the LICENSE file that accompanies this software package.
+	//! \author Michael C. Heiber
+	//! \date 2017-2020
+	class SiteHashMap {
+	public:
+		//! \brief This struct contains the state of one site that is stored in the map.
+		struct Entry {
+			//! The site index that is used as the key, which is -1 for empty slots.
+			int64_t site_index = -1;
+			//! The pointer to the Object that occupies the site.
+			Object* object_ptr = nullptr;
+			//! The pointer to the materialized Site object, which is nullptr if the site attributes have not been created.
+			Site* site_ptr = nullptr;
+			//! The occupancy state of the site.
+			bool occupied = false;
+		};
+
+		//! Default constructor that creates an empty SiteHashMap object.
+		SiteHashMap();
+
+		//! Removes all entries from the map and releases the memory.
+		void clear();
+
+		//! \brief Removes the entry with the input site index from the map.
+		//! \param site_index is the site index of the entry to be removed.
+		void erase(const int64_t site_index);
+
+		//! \brief Finds the entry with the input site index.
+		//! \param site_index is the site index of the entry to be found.
+		//! \return a pointer to the entry if it is in the map.
+		//! \return nullptr if the site index is not in the map.
+		Entry* find(const int64_t site_index);
+
+		//! \brief Finds the entry with the input site index.
+		//! \param site_index is the site index of the entry to be found.
+		//! \return a pointer to the entry if it is in the map.
+		//! \return nullptr if the site index is not in the map.
+		const Entry* find(const int64_t site_index) const;
+
+		//! \brief Gets all of the slots of the map, including the empty slots, which have a site index of -1.
+		//! \return a constant reference to the vector of map slots.
+		const std::vector<Entry>& getSlots() const;
+
+		//! \brief Finds the entry with the input site index or creates a new empty entry if it is not in the map.
+		//! \param site_index is the site index of the entry.
+		//! \return a reference to the entry.
+		Entry& insert(const int64_t site_index);
+
+		//! \brief Gets the number of entries stored in the map.
+		int64_t size() const;
+
+	private:
+		std::vector<Entry> slots;
+		int64_t N_entries = 0;
+		int64_t Slot_mask = 0;
+
+		// Calculates the hash of the input site index using a 64-bit integer mixing function.
+		static uint64_t calculateHash(const int64_t site_index);
+
+		// Finds the slot that contains the input site index or the empty slot where it would be inserted.
+		int64_t findSlot(const int64_t site_index) const;
+
+		// Reallocates the slots with the input capacity, which must be a power of two, and reinserts the entries.
+		void rehash(const int64_t capacity);
+	};
+}
+
+#endif // KMC_LATTICE_SITEHASHMAP_H
@@ -4,6 +4,9 @@
 // The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
 
 #include "Utils.h"
+#include "Histogram.h"
+#include <limits>
+#include <thread>
 
 using namespace std;
 
@@ -50,13 +53,10 @@ namespace KMC_Lattice {
 			cout << "Error! Cannot calculate histogram because bin size is less than 1." << endl;
 			throw invalid_argument("Error! Cannot calculate histogram because bin size is less than 1.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](int val) { return !isfinite((float)val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine the starting bin position
-		int min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		int max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the starting bin position, where all integer values are finite and do not need to be filtered
+		auto minmax_its = minmax_element(data.begin(), data.end());
+		int min_val = *minmax_its.first;
+		int max_val = *minmax_its.second;
 		// Determine number of bins
 		int num_bins = (int)((double)(max_val - min_val + 1) / (double)bin_size);
 		// Calculate bins
@@ -70,8 +70,8 @@ namespace KMC_Lattice {
 			}
 		}
 		// Calculate histogram
-		for (int i = 0; i < (int)data_filtered.size(); i++) {
-			int index = (data_filtered[i] - min_val) / bin_size;
+		for (auto const &item : data) {
+			int index = (item - min_val) / bin_size;
 			hist[index].second++;
 		}
 		return hist;
@@ -103,13 +103,10 @@ namespace KMC_Lattice {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](int val) { return !isfinite((float)val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine the starting bin position
-		int min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		int max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the starting bin position, where all integer values are finite and do not need to be filtered
+		auto minmax_its = minmax_element(data.begin(), data.end());
+		int min_val = *minmax_its.first;
+		int max_val = *minmax_its.second;
 		// Determine number of bins
 		int num_bins = (int)((double)(max_val - min_val + 1) / (double)bin_size);
 		// Calculate bins
@@ -119,10 +116,8 @@ namespace KMC_Lattice {
 		}
 		// Calculate histogram
 		vector<int> counts(num_bins, 0);
-		int index;
-		for (int i = 0; i < (int)data_filtered.size(); i++) {
-			index = (data_filtered[i] - min_val) / bin_size;
-			counts[index]++;
+		for (auto const &item : data) {
+			counts[(item - min_val) / bin_size]++;
 		}
 		// total counts
 		int total_counts = accumulate(counts.begin(), counts.end(), 0);
@@ -134,180 +129,212 @@ namespace KMC_Lattice {
 	}
 
 	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<double>& data, int num_bins) {
+		return calculateProbabilityHistParallel(data, num_bins, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, int num_bins) {
+		return calculateProbabilityHistParallel(data, num_bins, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<double>& data, double bin_size) {
+		return calculateProbabilityHistParallel(data, bin_size, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, double bin_size) {
+		return calculateProbabilityHistParallel(data, bin_size, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<double>& data, const double bin_size, const int num_bins) {
+		return calculateProbabilityHistParallel(data, bin_size, num_bins, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, const double bin_size, const int num_bins) {
+		return calculateProbabilityHistParallel(data, bin_size, num_bins, 1);
+	}
+
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, int num_bins, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](double val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine data range
-		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		double max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the number of finite values and their range
+		double min_val, max_val;
+		int64_t num_finite = Histogram::calculateRange(data, min_val, max_val, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
 		// Limit the number of bins to the number of data entries
-		if (num_bins > (int)data_filtered.size()) {
-			num_bins = (int)data_filtered.size();
+		if (num_bins > num_finite) {
+			num_bins = (int)num_finite;
 		}
+		const double max_val_data = max_val;
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12*abs(min_val);
 		max_val += 1e-12*abs(max_val);
 		// Determine bin size
 		double bin_size = (max_val - min_val) / num_bins;
-		return calculateProbabilityHist(data_filtered, bin_size, num_bins);
+		// Widen the bins slightly if rounding places the upper edge of the range below the maximum value
+		double range_end = max_val_data;
+		while (min_val + num_bins * bin_size < max_val_data) {
+			range_end = nextafter(range_end, numeric_limits<double>::infinity());
+			bin_size = (range_end - min_val) / num_bins;
+		}
+		Histogram hist(min_val, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, int num_bins) {
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, int num_bins, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](float val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine data range
-		float min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		float max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the number of finite values and their range
+		float min_val, max_val;
+		int64_t num_finite = Histogram::calculateRange(data, min_val, max_val, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
+		// The bins start from the minimum value extended in double precision
+		double bin_start = min_val;
+		bin_start -= 1e-12f*abs(bin_start);
 		// Limit the number of bins to the number of data entries
-		if (num_bins > (int)data_filtered.size()) {
-			num_bins = (int)data_filtered.size();
+		if (num_bins > num_finite) {
+			num_bins = (int)num_finite;
 		}
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12f*abs(min_val);
 		max_val += 1e-12f*abs(max_val);
 		// Determine bin size
 		double bin_size = (max_val - min_val) / num_bins;
-		return calculateProbabilityHist(data_filtered, bin_size, num_bins);
+		// Widen the bins slightly if rounding places the upper edge of the range below the maximum value
+		double range_end = (double)max_val;
+		while (bin_start + num_bins * bin_size < (double)max_val) {
+			range_end = nextafter(range_end, numeric_limits<double>::infinity());
+			bin_size = (range_end - bin_start) / num_bins;
+		}
+		Histogram hist(bin_start, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<double>& data, double bin_size) {
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, double bin_size, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](double val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine data range
-		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		double max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the number of finite values and their range
+		double min_val, max_val;
+		int64_t num_finite = Histogram::calculateRange(data, min_val, max_val, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
+		const double max_val_data = max_val;
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12*abs(min_val);
 		max_val += 1e-12*abs(max_val);
 		// Determine number of bins
 		int num_bins = (int)ceil((max_val - min_val) / bin_size);
 		// Limit the number of bins to the number of data entries
-		if (num_bins > (int)data_filtered.size()) {
-			num_bins = (int)data_filtered.size();
+		if (num_bins > num_finite) {
+			num_bins = (int)num_finite;
 			bin_size = (max_val - min_val) / (double)num_bins;
 		}
-		return calculateProbabilityHist(data_filtered, bin_size, num_bins);
+		// Widen the bins slightly if rounding places the upper edge of the range below the maximum value
+		double range_end = max_val_data;
+		while (min_val + num_bins * bin_size < max_val_data) {
+			range_end = nextafter(range_end, numeric_limits<double>::infinity());
+			bin_size = (range_end - min_val) / num_bins;
+		}
+		Histogram hist(min_val, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, double bin_size) {
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, double bin_size, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](float val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
-		// Determine data range
-		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
-		double max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		// Determine the number of finite values and their range
+		float min_val_data, max_val_data;
+		int64_t num_finite = Histogram::calculateRange(data, min_val_data, max_val_data, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
+		double min_val = min_val_data;
+		double max_val = max_val_data;
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12f*abs(min_val);
 		max_val += 1e-12f*abs(max_val);
 		// Determine number of bins
 		int num_bins = (int)ceil((max_val - min_val) / bin_size);
 		// Limit the number of bins to the number of data entries
-		if (num_bins > (int)data_filtered.size()) {
-			num_bins = (int)data_filtered.size();
+		if (num_bins > num_finite) {
+			num_bins = (int)num_finite;
 			bin_size = (max_val - min_val) / (double)num_bins;
 		}
-		return calculateProbabilityHist(data_filtered, bin_size, num_bins);
+		// Widen the bins slightly if rounding places the upper edge of the range below the maximum value
+		double range_end = max_val_data;
+		while (min_val + num_bins * bin_size < max_val_data) {
+			range_end = nextafter(range_end, numeric_limits<double>::infinity());
+			bin_size = (range_end - min_val) / num_bins;
+		}
+		Histogram hist(min_val, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<double>& data, const double bin_size, const int num_bins) {
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, const double bin_size, const int num_bins, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](double val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
 		// Determine the starting bin position
-		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
+		double min_val, max_val;
+		int64_t num_finite = Histogram::calculateRange(data, min_val, max_val, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12*abs(min_val);
-		// Calculate bin-centered x values
-		vector<pair<double, double>> hist(num_bins, make_pair(0.0, 0.0));
-		for (int i = 0; i < num_bins; i++) {
-			hist[i].first = min_val + 0.5*bin_size + bin_size * i;
-		}
-		// Calculate histogram
-		vector<int> counts(num_bins, 0);
-		for (int i = 0; i < (int)data_filtered.size(); i++) {
-			int index = (int)floor((data_filtered[i] - min_val) / bin_size);
-			// Check for rare rounding error that calculates the index as num_bins
-			if (index == num_bins) {
-				index--;
-			}
-			counts[index]++;
-		}
-		// Normalized histogram to get probability
-		for (int i = 0; i < num_bins; i++) {
-			hist[i].second = (double)counts[i] / (double)data_filtered.size();
-		}
-		return hist;
+		Histogram hist(min_val, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, const double bin_size, const int num_bins) {
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, const double bin_size, const int num_bins, const int num_threads) {
 		// Check for valid input data
 		if ((int)data.size() == 0) {
 			cout << "Error! Cannot calculate probability histogram because the input data vector is empty." << endl;
 			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector is empty.");
 		}
-		// Remove any invalid data from the vector
-		auto data_filtered = data;
-		auto it = remove_if(data_filtered.begin(), data_filtered.end(), [](float val) { return !isfinite(val); });
-		data_filtered.erase(it, data_filtered.end());
 		// Determine the starting bin position
-		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
+		float min_val_data, max_val_data;
+		int64_t num_finite = Histogram::calculateRange(data, min_val_data, max_val_data, num_threads);
+		if (num_finite == 0) {
+			cout << "Error! Cannot calculate probability histogram because the input data vector does not contain any finite values." << endl;
+			throw invalid_argument("Error! Cannot calculate probability histogram because the input data vector does not contain any finite values.");
+		}
+		double min_val = min_val_data;
 		// Extend the range a little bit to ensure all data fits in the range
 		min_val -= 1e-12f*abs(min_val);
-		// Calculate bin-centered x values
-		vector<pair<double, double>> hist(num_bins, make_pair(0.0, 0.0));
-		for (int i = 0; i < num_bins; i++) {
-			hist[i].first = min_val + 0.5*bin_size + bin_size * i;
-		}
-		// Calculate histogram
-		vector<int> counts(num_bins, 0);
-		for (int i = 0; i < (int)data_filtered.size(); i++) {
-			int index = (int)floor(((double)data_filtered[i] - min_val) / bin_size);
-			// Check for rare rounding error that calculates the index as num_bins
-			if (index == num_bins) {
-				index--;
-			}
-			counts[index]++;
-		}
-		// Normalized histogram to get probability
-		for (int i = 0; i < num_bins; i++) {
-			hist[i].second = (double)counts[i] / (double)data_filtered.size();
-		}
-		return hist;
+		Histogram hist(min_val, bin_size, num_bins);
+		hist.addSamples(data, num_threads);
+		return hist.calculateProbabilityHist();
 	}
 
-	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, std::mt19937_64& gen) {
+	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, RandomEngine& gen) {
 		exponential_distribution<double> dist_exp(1.0 / urbach_energy);
 		auto rand_exp = bind(dist_exp, ref(gen));
 		normal_distribution<double> dist_gaus(0.0, 2.0*urbach_energy / sqrt(2.0 * Pi));
@@ -321,7 +348,7 @@ namespace KMC_Lattice {
 		}
 	}
 
-	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, std::mt19937_64& gen) {
+	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, RandomEngine& gen) {
 		exponential_distribution<float> dist_exp(1.0f / (float)urbach_energy);
 		auto rand_exp = bind(dist_exp, ref(gen));
 		normal_distribution<float> dist_gaus(0.0f, 2.0f*(float)urbach_energy / sqrt(2.0f * (float)Pi));
@@ -338,18 +365,71 @@ namespace KMC_Lattice {
 		}
 	}
 
-	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, std::mt19937_64& gen) {
+	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, const uint64_t seed, const int num_threads) {
+		double stdev_gaus = 2.0*urbach_energy / sqrt(2.0 * Pi);
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			uint32_t block[4];
+			for (int64_t n = index_start; n < index_end; n++) {
+				Philox4x32::generateBlock(seed, (uint64_t)n, 0, block);
+				// Box-Muller transform of the first block, with a second block drawn only for the exponential side
+				double energy = stdev_gaus * sqrt(-2.0*log(Philox4x32::convertToDouble(block[0], block[1])))*cos(2.0*Pi*Philox4x32::convertToDouble(block[2], block[3]));
+				if (energy < 0) {
+					Philox4x32::generateBlock(seed, (uint64_t)n, 1, block);
+					energy = urbach_energy * log(Philox4x32::convertToDouble(block[0], block[1]));
+				}
+				data[n] = mode + energy;
+			}
+		});
+	}
+
+	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, const uint64_t seed, const int num_threads) {
+		double stdev_gaus = 2.0*urbach_energy / sqrt(2.0 * Pi);
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			uint32_t block[4];
+			for (int64_t n = index_start; n < index_end; n++) {
+				Philox4x32::generateBlock(seed, (uint64_t)n, 0, block);
+				double energy = stdev_gaus * sqrt(-2.0*log(Philox4x32::convertToDouble(block[0], block[1])))*cos(2.0*Pi*Philox4x32::convertToDouble(block[2], block[3]));
+				if (energy < 0) {
+					Philox4x32::generateBlock(seed, (uint64_t)n, 1, block);
+					energy = urbach_energy * log(Philox4x32::convertToDouble(block[0], block[1]));
+				}
+				data[n] = (float)(mode + energy);
+			}
+		});
+	}
+
+	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, RandomEngine& gen) {
 		normal_distribution<double> dist(mean, stdev);
 		auto rand_gaus = bind(dist, ref(gen));
 		generate(data.begin(), data.end(), rand_gaus);
 	}
 
-	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, std::mt19937_64& gen) {
+	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, RandomEngine& gen) {
 		normal_distribution<float> dist((float)mean, (float)stdev);
 		auto rand_gaus = bind(dist, ref(gen));
 		generate(data.begin(), data.end(), rand_gaus);
 	}
 
+	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, const uint64_t seed, const int num_threads) {
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			uint32_t block[4];
+			for (int64_t n = index_start; n < index_end; n++) {
+				Philox4x32::generateBlock(seed, (uint64_t)n, 0, block);
+				data[n] = mean + stdev * sqrt(-2.0*log(Philox4x32::convertToDouble(block[0], block[1])))*cos(2.0*Pi*Philox4x32::convertToDouble(block[2], block[3]));
+			}
+		});
+	}
+
+	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, const uint64_t seed, const int num_threads) {
+		parallelFor(0, (int64_t)data.size(), num_threads, [&](const int64_t index_start, const int64_t index_end) {
+			uint32_t block[4];
+			for (int64_t n = index_start; n < index_end; n++) {
+				Philox4x32::generateBlock(seed, (uint64_t)n, 0, block);
+				data[n] = (float)(mean + stdev * sqrt(-2.0*log(Philox4x32::convertToDouble(block[0], block[1])))*cos(2.0*Pi*Philox4x32::convertToDouble(block[2], block[3])));
+			}
+		});
+	}
+
 	double integrateData(const std::vector<std::pair<double, double>>& data) {
 		double area = 0;
 		for (int i = 1; i < (int)data.size(); i++) {
@@ -706,6 +786,46 @@ namespace KMC_Lattice {
 		return output_vector;
 	}
 
+	void parallelFor(const int64_t index_start, const int64_t index_end, const int num_threads, const std::function<void(const int64_t, const int64_t)>& func) {
+		if (index_end <= index_start) {
+			return;
+		}
+		int64_t N_threads = (num_threads > 0) ? num_threads : max((int)thread::hardware_concurrency(), 1);
+		N_threads = min(N_threads, index_end - index_start);
+		int64_t block_size = (index_end - index_start) / N_threads;
+		int64_t remainder = (index_end - index_start) % N_threads;
+		vector<thread> threads;
+		vector<exception_ptr> exceptions(N_threads);
+		int64_t block_start = index_start;
+		for (int64_t n = 0; n < N_threads; n++) {
+			// The first blocks are each one index larger to distribute the remainder
+			int64_t block_end = block_start + block_size + ((n < remainder) ? 1 : 0);
+			auto run_block = [&func, &exceptions, n, block_start, block_end]() {
+				try {
+					func(block_start, block_end);
+				}
+				catch (...) {
+					exceptions[n] = current_exception();
+				}
+			};
+			if (n < N_threads - 1) {
+				threads.push_back(thread(run_block));
+			}
+			else {
+				run_block();
+			}
+			block_start = block_end;
+		}
+		for (auto &item : threads) {
+			item.join();
+		}
+		for (auto const &item : exceptions) {
+			if (item) {
+				rethrow_exception(item);
+			}
+		}
+	}
+
 	std::string removeWhitespace(const std::string& str_input) {
 		// Remove tab characters
 		string str_out = str_input;
@@ -6,8 +6,10 @@
 #ifndef KMC_LATTICE_UTILS_H
 #define KMC_LATTICE_UTILS_H
 
+#include "Random.h"
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -161,6 +163,68 @@ namespace KMC_Lattice {
 	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
 	std::vector<std::pair<double, double>> calculateProbabilityHist(const std::vector<float>& data, const double bin_size, const int num_bins);
 
+	//! \brief Calculates the probability histogram for the input double data vector using the input number of bins and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param num_bins is the desired number of bins.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, int num_bins, const int num_threads);
+
+	//! \brief Calculates the probability histogram for the input float data vector using the input number of bins and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param num_bins is the desired number of bins.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, int num_bins, const int num_threads);
+
+	//! \brief Calculates the probability histogram for the input double data vector using the input bin size and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param bin_size is the desired bin size.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, double bin_size, const int num_threads);
+
+	//! \brief Calculates the probability histogram for the input float data vector using the input bin size and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param bin_size is the desired bin size.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, double bin_size, const int num_threads);
+
+	//! \brief Calculates the probability histogram for the input double data vector using the input bin size, input number of bins, and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param bin_size is the input bin size.
+	//! \param num_bins is the number of bins that will be created.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<double>& data, const double bin_size, const int num_bins, const int num_threads);
+
+	//! \brief Calculates the probability histogram for the input float data vector using the input bin size, input number of bins, and multiple threads.
+	//! \details The bins depend on the range of the data, so each thread reads its contiguous block of the data twice, first to find
+	//! the range and then to count the block in thread-local bins that are merged at the end. The result is the same as that of
+	//! calculateProbabilityHist for any number of threads.
+	//! \param data is the input data vector.
+	//! \param bin_size is the input bin size.
+	//! \param num_bins is the number of bins that will be created.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \returns A vector of x-y pairs consisting of bin-centered x values and probability y values.
+	std::vector<std::pair<double, double>> calculateProbabilityHistParallel(const std::vector<float>& data, const double bin_size, const int num_bins, const int num_threads);
+
 	//! \brief Creates a vector of doubles that has a custom asymmetric distribution with an exponential tail.
 	//! \details The created distribution is Gaussian in the positive direction relative to the mode and exponential in 
 	//! the negative direction. On the Gaussian side, the standard deviation is calculated relative to the Urbach energy
@@ -168,8 +232,8 @@ namespace KMC_Lattice {
 	//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
 	//! \param mode is the value of the peak of the distribution.
 	//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
-	//! \param gen is a Mersenne twister random number generator used to randomly draw numbers from the distribution.
-	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, std::mt19937_64& gen);
+	//! \param gen is the random number generator engine used to randomly draw numbers from the distribution.
+	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, RandomEngine& gen);
 
 	//! \brief Creates a vector of floats that has a custom asymmetric distribution with an exponential tail.
 	//! \details The created distribution is Gaussian in the positive direction relative to the mode and exponential in 
@@ -178,22 +242,64 @@ namespace KMC_Lattice {
 	//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
 	//! \param mode is the value of the peak of the distribution.
 	//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
-	//! \param gen is a Mersenne twister random number generator used to randomly draw numbers from the distribution.
-	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, std::mt19937_64& gen);
+	//! \param gen is the random number generator engine used to randomly draw numbers from the distribution.
+	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, RandomEngine& gen);
+
+	//! \brief Creates a vector of doubles that has a custom asymmetric distribution with an exponential tail using multiple threads.
+	//! \details The distribution is the same as the one created by the version of the function that uses a random number generator engine.
+	//! Each element is drawn from the Philox4x32 counter-based generator using the element index as the counter, so the
+	//! resulting data only depends on the seed and not on the number of threads.
+	//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
+	//! \param mode is the value of the peak of the distribution.
+	//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
+	//! \param seed is the seed of the counter-based random number generator.
+	//! \param num_threads is the number of threads used to fill the vector, where values less than one select the number of hardware threads.
+	void createExponentialDOSVector(std::vector<double>& data, const double mode, const double urbach_energy, const uint64_t seed, const int num_threads);
+
+	//! \brief Creates a vector of floats that has a custom asymmetric distribution with an exponential tail using multiple threads.
+	//! \details The distribution is the same as the one created by the version of the function that uses a random number generator engine.
+	//! Each element is drawn from the Philox4x32 counter-based generator using the element index as the counter, so the
+	//! resulting data only depends on the seed and not on the number of threads.
+	//! \param data is the data vector where the random numbers will be placed, which must be preallocated to the desired size.
+	//! \param mode is the value of the peak of the distribution.
+	//! \param urbach_energy is the parameter that determines the shape of the exponential tail side of the distribution.
+	//! \param seed is the seed of the counter-based random number generator.
+	//! \param num_threads is the number of threads used to fill the vector, where values less than one select the number of hardware threads.
+	void createExponentialDOSVector(std::vector<float>& data, const double mode, const double urbach_energy, const uint64_t seed, const int num_threads);
 
 	//! \brief Creates a vector of doubles that has a Gaussian distribution.
 	//! \param data is the data vector where the numbers will be placed, which must be preallocated to the desired size.
 	//! \param mean is the position of the peak and center of the distribution.
 	//! \param stdev is the standard deviation of the distribution, which defines the width of the peak.
-	//! \param gen is a Mersenne twister random number generator used to randomly draw numbers from the distribution.
-	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, std::mt19937_64& gen);
+	//! \param gen is the random number generator engine used to randomly draw numbers from the distribution.
+	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, RandomEngine& gen);
 
 	//! \brief Creates a vector of floats that has a Gaussian distribution.
 	//! \param data is the data vector where the numbers will be placed, which must be preallocated to the desired size.
 	//! \param mean is the position of the peak and center of the distribution.
 	//! \param stdev is the standard deviation of the distribution, which defines the width of the peak.
-	//! \param gen is a Mersenne twister random number generator used to randomly draw numbers from the distribution.
-	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, std::mt19937_64& gen);
+	//! \param gen is the random number generator engine used to randomly draw numbers from the distribution.
+	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, RandomEngine& gen);
+
+	//! \brief Creates a vector of doubles that has a Gaussian distribution using multiple threads.
+	//! \details Each element is drawn from the Philox4x32 counter-based generator using the element index as the counter, so the
+	//! resulting data only depends on the seed and not on the number of threads.
+	//! \param data is the data vector where the numbers will be placed, which must be preallocated to the desired size.
+	//! \param mean is the position of the peak and center of the distribution.
+	//! \param stdev is the standard deviation of the distribution, which defines the width of the peak.
+	//! \param seed is the seed of the counter-based random number generator.
+	//! \param num_threads is the number of threads used to fill the vector, where values less than one select the number of hardware threads.
+	void createGaussianDOSVector(std::vector<double>& data, const double mean, const double stdev, const uint64_t seed, const int num_threads);
+
+	//! \brief Creates a vector of floats that has a Gaussian distribution using multiple threads.
+	//! \details Each element is drawn from the Philox4x32 counter-based generator using the element index as the counter, so the
+	//! resulting data only depends on the seed and not on the number of threads.
+	//! \param data is the data vector where the numbers will be placed, which must be preallocated to the desired size.
+	//! \param mean is the position of the peak and center of the distribution.
+	//! \param stdev is the standard deviation of the distribution, which defines the width of the peak.
+	//! \param seed is the seed of the counter-based random number generator.
+	//! \param num_threads is the number of threads used to fill the vector, where values less than one select the number of hardware threads.
+	void createGaussianDOSVector(std::vector<float>& data, const double mean, const double stdev, const uint64_t seed, const int num_threads);
 
 	//! \brief Numerically integrates a vector of x-y data using the trapezoid rule.
 	//! \warning The function assumes that the data is sorted by the x values.
@@ -290,6 +396,15 @@ namespace KMC_Lattice {
 	//! \return An empty vector when called on other processors.
 	std::vector<int> MPI_gatherVectors(const std::vector<int>& input_vector);
 
+	//! \brief Calls a function for contiguous blocks of an index range using multiple threads.
+	//! \details The index range is divided into one block per thread, and the calling thread processes the last block.
+	//! Any exception thrown by the function is rethrown on the calling thread after all threads have finished.
+	//! \param index_start is the first index of the range.
+	//! \param index_end is the index one past the last index of the range.
+	//! \param num_threads is the number of threads to use, where values less than one select the number of hardware threads.
+	//! \param func is the function that is called with the first index and the index one past the last index of each block.
+	void parallelFor(const int64_t index_start, const int64_t index_end, const int num_threads, const std::function<void(const int64_t, const int64_t)>& func);
+
 	//! \brief Removes all spaces and tab characters in a string.
 	//! \param str is the input string
 	//! \returns a new string that will have the whitespace removed.
@@ -0,0 +1,362 @@
+// Copyright (c) 2017-2020 Michael C. Heiber
+// This source file is part of the KMC_Lattice project, which is subject to the MIT License.
+// For more information, see the LICENSE file that accompanies this software.
+// The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
+
+#include "Simulation.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace KMC_Lattice;
+
+// Simple derived Simulation class that performs random nearest neighbor moves of a fixed set of objects
+class BenchmarkSim : public Simulation {
+public:
+	list<Object> objects;
+	vector<Site> sites;
+	vector<Object*> object_ptrs;
+	vector<int> directions;
+
+	bool init(const Parameters_Simulation& params, const int num_objects, const int num_directions) {
+		Simulation::init(params, 0);
+		sites.assign((size_t)lattice.getNumSites(), Site());
+		lattice.setSites(sites, 0);
+		while ((int)objects.size() < num_objects) {
+			Coords coords = lattice.generateRandomCoords();
+			if (!lattice.isOccupied(coords)) {
+				objects.push_back(Object(0.0, (int)objects.size(), coords));
+				object_ptrs.push_back(&objects.back());
+				lattice.setOccupied(coords);
+			}
+		}
+		for (auto const &item : object_ptrs) {
+			lattice.clearOccupancy(item->getCoords());
+		}
+		addObjects(object_ptrs);
+		// Pregenerate the move directions so that the random number generation is not included in the timing
+		uniform_int_distribution<int> dist(0, 5);
+		directions.resize(num_directions);
+		for (auto &item : directions) {
+			item = dist(generator);
+		}
+		return true;
+	}
+
+	bool checkFinished() const {
+		return true;
+	}
+
+	bool executeNextEvent() {
+		return true;
+	}
+
+	// Moves the object using the separate occupancy and periodic boundary functions in the same way as the original moveObject function
+	void moveObjectUnfused(Object* object_ptr, const Coords& coords_dest) {
+		Coords coords_initial = object_ptr->getCoords();
+		lattice.clearOccupancy(lattice.getSiteIndexUnchecked(coords_initial));
+		object_ptr->incrementDX(-lattice.calculateDX(coords_initial, coords_dest));
+		object_ptr->incrementDY(-lattice.calculateDY(coords_initial, coords_dest));
+		object_ptr->incrementDZ(-lattice.calculateDZ(coords_initial, coords_dest));
+		object_ptr->setCoords(coords_dest);
+		lattice.setObjectPtr(lattice.getSiteIndexUnchecked(coords_dest), object_ptr);
+	}
+
+	// Performs the input number of move attempts and returns the number of completed moves per second
+	double runMoves(const int num_moves, const bool enable_fused) {
+		static const int displacements[6][3] = { { -1,0,0 },{ 1,0,0 },{ 0,-1,0 },{ 0,1,0 },{ 0,0,-1 },{ 0,0,1 } };
+		int num_completed = 0;
+		auto time_start = chrono::steady_clock::now();
+		for (int n = 0; n < num_moves; n++) {
+			Object* object_ptr = object_ptrs[n % object_ptrs.size()];
+			const int* displacement = displacements[directions[n % directions.size()]];
+			Coords coords_dest;
+			lattice.calculateDestinationCoords(object_ptr->getCoords(), displacement[0], displacement[1], displacement[2], coords_dest);
+			int64_t site_index_dest = lattice.getSiteIndexUnchecked(coords_dest);
+			if (lattice.isOccupied(site_index_dest)) {
+				continue;
+			}
+			if (enable_fused) {
+				moveObject(object_ptr, coords_dest, site_index_dest);
+			}
+			else {
+				moveObjectUnfused(object_ptr, coords_dest);
+			}
+			num_completed++;
+		}
+		auto time_end = chrono::steady_clock::now();
+		return num_completed / chrono::duration<double>(time_end - time_start).count();
+	}
+
+	// Generates the input number of uniform random numbers and returns the number generated per second
+	double runRand01(const int num_numbers, const bool enable_buffer, double& checksum) {
+		double sum = 0.0;
+		auto time_start = chrono::steady_clock::now();
+		if (enable_buffer) {
+			for (int n = 0; n < num_numbers; n++) {
+				sum += rand01();
+			}
+		}
+		else {
+			for (int n = 0; n < num_numbers; n++) {
+				sum += generate_canonical<double, numeric_limits<double>::digits>(generator);
+			}
+		}
+		auto time_end = chrono::steady_clock::now();
+		checksum += sum;
+		return num_numbers / chrono::duration<double>(time_end - time_start).count();
+	}
+
+	// Chooses a random unoccupied neighbor using a vector and a new distribution in the same way as the original chooseRandomUnoccupiedNeighbor function
+	Coords chooseNeighborVector(const Coords& coords_i) {
+		static const int displacements[6][3] = { { -1,0,0 },{ 1,0,0 },{ 0,-1,0 },{ 0,1,0 },{ 0,0,-1 },{ 0,0,1 } };
+		vector<Coords> coords_vec;
+		coords_vec.reserve(6);
+		Coords coords_f;
+		for (int n = 0; n < 6; n++) {
+			if (lattice.checkMoveValidity(coords_i, displacements[n][0], displacements[n][1], displacements[n][2])) {
+				lattice.calculateDestinationCoords(coords_i, displacements[n][0], displacements[n][1], displacements[n][2], coords_f);
+				if (!lattice.isOccupied(coords_f)) {
+					coords_vec.push_back(coords_f);
+				}
+			}
+		}
+		if (coords_vec.empty()) {
+			return Coords(-1, -1, -1);
+		}
+		uniform_int_distribution<> dist(0, (int)coords_vec.size() - 1);
+		return coords_vec[dist(generator)];
+	}
+
+	// Chooses random unoccupied neighbors of the objects and returns the number of selections per second
+	double runNeighborSelection(const int num_selections, const bool enable_sampler, double& checksum) {
+		int64_t sum = 0;
+		auto time_start = chrono::steady_clock::now();
+		for (int n = 0; n < num_selections; n++) {
+			const Coords& coords = object_ptrs[n % object_ptrs.size()]->getCoords();
+			Coords coords_dest = enable_sampler ? lattice.chooseRandomUnoccupiedNeighbor(coords) : chooseNeighborVector(coords);
+			sum += coords_dest.x + coords_dest.y + coords_dest.z;
+		}
+		auto time_end = chrono::steady_clock::now();
+		checksum += (double)sum;
+		return num_selections / chrono::duration<double>(time_end - time_start).count();
+	}
+
+	// Generates the input number of random lattice coordinates and returns the number generated per second
+	double runRandomCoords(const int num_coords, const bool enable_sampler, double& checksum) {
+		int64_t sum = 0;
+		auto time_start = chrono::steady_clock::now();
+		if (enable_sampler) {
+			for (int n = 0; n < num_coords; n++) {
+				Coords coords = lattice.generateRandomCoords();
+				sum += coords.x + coords.y + coords.z;
+			}
+		}
+		else {
+			// Constructs the distributions on every call in the same way as the original generateRandomX, generateRandomY, and generateRandomZ functions
+			for (int n = 0; n < num_coords; n++) {
+				uniform_int_distribution<int> distx(0, lattice.getLength() - 1);
+				int x = distx(generator);
+				uniform_int_distribution<int> disty(0, lattice.getWidth() - 1);
+				int y = disty(generator);
+				uniform_int_distribution<int> distz(0, lattice.getHeight() - 1);
+				sum += x + y + distz(generator);
+			}
+		}
+		auto time_end = chrono::steady_clock::now();
+		checksum += (double)sum;
+		return num_coords / chrono::duration<double>(time_end - time_start).count();
+	}
+
+	// Generates the input number of exponentially distributed random numbers and returns the number generated per second
+	double runRandExp(const int num_numbers, const bool enable_ziggurat, double& checksum) {
+		double sum = 0.0;
+		auto time_start = chrono::steady_clock::now();
+		if (enable_ziggurat) {
+			for (int n = 0; n < num_numbers; n++) {
+				sum += randExp();
+			}
+		}
+		else {
+			for (int n = 0; n < num_numbers; n++) {
+				sum -= log(rand01());
+			}
+		}
+		auto time_end = chrono::steady_clock::now();
+		checksum += sum;
+		return num_numbers / chrono::duration<double>(time_end - time_start).count();
+	}
+
+	// Calculates the mean squared displacement of all objects the input number of times and returns the number of object displacements per second
+	double runMSD(const int num_repeats, const bool enable_store, double& checksum) {
+		double sum = 0.0;
+		auto time_start = chrono::steady_clock::now();
+		if (enable_store) {
+			for (int n = 0; n < num_repeats; n++) {
+				sum += getObjectStore().calculateMeanSquaredDisplacement();
+			}
+		}
+		else {
+			// Follows the pointer to each Object in the object list in the same way as the derived simulations
+			for (int n = 0; n < num_repeats; n++) {
+				double msd = 0.0;
+				for (auto const &item : objects) {
+					double displacement = item.calculateDisplacement();
+					msd += displacement * displacement;
+				}
+				sum += msd / objects.size();
+			}
+		}
+		auto time_end = chrono::steady_clock::now();
+		checksum += sum;
+		return (double)num_repeats * objects.size() / chrono::duration<double>(time_end - time_start).count();
+	}
+};
+
+// Performs the random number generation of the input number of events with the input engine and returns the number of events per second
+// Each event draws a uniform random number for event selection, an exponential waiting time, and a nearest neighbor direction, as in the
+// execution of a typical hopping event
+template<typename Engine>
+double runEngineEvents(const int num_events, double& checksum) {
+	Engine gen(12345);
+	uniform_int_distribution<int> dist_direction(0, 5);
+	const double rate = 1e12;
+	double sum = 0.0;
+	auto time_start = chrono::steady_clock::now();
+	for (int n = 0; n < num_events; n++) {
+		double target = generate_canonical<double, numeric_limits<double>::digits>(gen);
+		double wait_time = -log(1.0 - generate_canonical<double, numeric_limits<double>::digits>(gen)) / rate;
+		sum += target + wait_time + dist_direction(gen);
+	}
+	auto time_end = chrono::steady_clock::now();
+	// The checksum is printed so that the compiler cannot remove the generation
+	checksum += sum;
+	return num_events / chrono::duration<double>(time_end - time_start).count();
+}
+
+// Calculates the probability histogram of the input data with the input number of threads and returns the number of entries per second,
+// where a number of threads less than one uses the single-threaded function
+double runHistogram(const vector<double>& data, const int num_threads, double& checksum) {
+	auto time_start = chrono::steady_clock::now();
+	auto hist = (num_threads < 1) ? calculateProbabilityHist(data, 1000) : calculateProbabilityHistParallel(data, 1000, num_threads);
+	auto time_end = chrono::steady_clock::now();
+	checksum += hist[hist.size() / 2].second;
+	return data.size() / chrono::duration<double>(time_end - time_start).count();
+}
+
+template<typename Engine>
+void benchmarkEngine(const string& name, const int num_events) {
+	double checksum = 0.0;
+	runEngineEvents<Engine>(num_events / 10, checksum);
+	double rate = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate = max(rate, runEngineEvents<Engine>(num_events, checksum));
+	}
+	cout << name << ": " << rate / 1e6 << " million events per second (checksum " << checksum << ")" << endl;
+}
+
+int main() {
+	Parameters_Simulation params;
+	params.Enable_logging = false;
+	params.Params_lattice.Enable_periodic_x = true;
+	params.Params_lattice.Enable_periodic_y = true;
+	params.Params_lattice.Enable_periodic_z = true;
+	params.Params_lattice.Length = 100;
+	params.Params_lattice.Width = 100;
+	params.Params_lattice.Height = 100;
+	params.Params_lattice.Unit_size = 1.0;
+	params.Temperature = 300;
+	params.Enable_FRM = false;
+	params.Enable_selective_recalc = true;
+	params.Recalc_cutoff = 3;
+	params.Enable_full_recalc = false;
+	const int num_moves = 20000000;
+	cout << "Object move benchmark on a " << params.Params_lattice.Length << " x " << params.Params_lattice.Width << " x " << params.Params_lattice.Height << " periodic lattice with 10000 objects" << endl;
+	BenchmarkSim sim_unfused;
+	sim_unfused.init(params, 10000, 1 << 20);
+	BenchmarkSim sim_fused;
+	sim_fused.init(params, 10000, 1 << 20);
+	// Warm up both simulations and then alternate the timed runs, keeping the best rate of each to reduce the timing noise
+	sim_unfused.runMoves(num_moves / 10, false);
+	sim_fused.runMoves(num_moves / 10, true);
+	double rate_unfused = 0.0;
+	double rate_fused = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_unfused = max(rate_unfused, sim_unfused.runMoves(num_moves, false));
+		rate_fused = max(rate_fused, sim_fused.runMoves(num_moves, true));
+	}
+	cout << "Separate occupancy and boundary updates: " << rate_unfused / 1e6 << " million moves per second" << endl;
+	cout << "Fused moveObject: " << rate_fused / 1e6 << " million moves per second" << endl;
+	cout << "Speedup: " << rate_fused / rate_unfused << endl;
+	cout << endl << "Uniform random number benchmark with the " << (sizeof(RandomEngine::result_type) * 8) << "-bit default engine" << endl;
+	double checksum = 0.0;
+	double rate_canonical = 0.0;
+	double rate_buffered = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_canonical = max(rate_canonical, sim_fused.runRand01(num_moves, false, checksum));
+		rate_buffered = max(rate_buffered, sim_fused.runRand01(num_moves, true, checksum));
+	}
+	cout << "generate_canonical: " << rate_canonical / 1e6 << " million numbers per second" << endl;
+	cout << "Buffered rand01: " << rate_buffered / 1e6 << " million numbers per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_buffered / rate_canonical << endl;
+	cout << endl << "Exponential random number benchmark" << endl;
+	double rate_log = 0.0;
+	double rate_ziggurat = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_log = max(rate_log, sim_fused.runRandExp(num_moves, false, checksum));
+		rate_ziggurat = max(rate_ziggurat, sim_fused.runRandExp(num_moves, true, checksum));
+	}
+	cout << "-log(rand01()): " << rate_log / 1e6 << " million numbers per second" << endl;
+	cout << "Ziggurat randExp: " << rate_ziggurat / 1e6 << " million numbers per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_ziggurat / rate_log << endl;
+	cout << endl << "Random site coordinate and neighbor selection benchmark" << endl;
+	double rate_distribution = 0.0;
+	double rate_sampler = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_distribution = max(rate_distribution, sim_fused.runRandomCoords(num_moves, false, checksum));
+		rate_sampler = max(rate_sampler, sim_fused.runRandomCoords(num_moves, true, checksum));
+	}
+	cout << "uniform_int_distribution: " << rate_distribution / 1e6 << " million coordinates per second" << endl;
+	cout << "Bounded samplers: " << rate_sampler / 1e6 << " million coordinates per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_sampler / rate_distribution << endl;
+	double rate_vector = 0.0;
+	double rate_stack = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_vector = max(rate_vector, sim_fused.runNeighborSelection(num_moves, false, checksum));
+		rate_stack = max(rate_stack, sim_fused.runNeighborSelection(num_moves, true, checksum));
+	}
+	cout << "Neighbor selection with a vector: " << rate_vector / 1e6 << " million selections per second" << endl;
+	cout << "Neighbor selection with a stack buffer: " << rate_stack / 1e6 << " million selections per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_stack / rate_vector << endl;
+	cout << endl << "Mean squared displacement benchmark with 10000 objects" << endl;
+	double rate_objects = 0.0;
+	double rate_store = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_objects = max(rate_objects, sim_fused.runMSD(2000, false, checksum));
+		rate_store = max(rate_store, sim_fused.runMSD(2000, true, checksum));
+	}
+	cout << "Object calculateDisplacement loop: " << rate_objects / 1e6 << " million objects per second" << endl;
+	cout << "ObjectStore kernel: " << rate_store / 1e6 << " million objects per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_store / rate_objects << endl;
+	int num_threads = max((int)thread::hardware_concurrency(), 1);
+	cout << endl << "Probability histogram benchmark with 5e7 double entries and " << num_threads << " threads" << endl;
+	vector<double> data((int)5e7);
+	createGaussianDOSVector(data, 0.0, 0.1, 12345, 0);
+	double rate_serial = 0.0;
+	double rate_parallel = 0.0;
+	for (int n = 0; n < 5; n++) {
+		rate_serial = max(rate_serial, runHistogram(data, 0, checksum));
+		rate_parallel = max(rate_parallel, runHistogram(data, num_threads, checksum));
+	}
+	cout << "calculateProbabilityHist: " << rate_serial / 1e6 << " million entries per second" << endl;
+	cout << "calculateProbabilityHistParallel: " << rate_parallel / 1e6 << " million entries per second (checksum " << checksum << ")" << endl;
+	cout << "Speedup: " << rate_parallel / rate_serial << endl;
+	cout << endl << "Random number engine benchmark of the per-event random number generation" << endl;
+	const int num_events = 10000000;
+	benchmarkEngine<mt19937_64>("mt19937_64", num_events);
+	benchmarkEngine<Xoshiro256pp>("Xoshiro256pp", num_events);
+	benchmarkEngine<Pcg64>("Pcg64", num_events);
+	benchmarkEngine<Philox4x32>("Philox4x32", num_events);
+	return 0;
+}
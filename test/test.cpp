@@ -4,6 +4,8 @@
 // The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
 
 #include "gtest/gtest.h"
+#include "Histogram.h"
+#include "Random.h"
 #include "Simulation.h"
 #include "Utils.h"
 #include "Version.h"
@@ -43,17 +45,19 @@ public:
 	vector<int> move_counts;
 	vector<double> displacement_data;
 
-	bool init(const Parameters_Simulation& params) {
+	bool init(const Parameters_Simulation& params, const int id = 0) {
 		// Initialize Simulation base class
-		Simulation::init(params, 0);
-		// Initialize Sites
-		Site site;
-		sites.assign(lattice.getNumSites(), site);
-		vector<Site*> site_ptrs;
-		for (auto& item : sites) {
-			site_ptrs.push_back(&item);
+		Simulation::init(params, id);
+		// Initialize Sites, which are not needed when the lattice uses sparse storage
+		if (!lattice.isSparse()) {
+			Site site;
+			sites.assign(lattice.getNumSites(), site);
+			vector<Site*> site_ptrs;
+			for (auto& item : sites) {
+				site_ptrs.push_back(&item);
+			}
+			lattice.setSitePointers(site_ptrs);
 		}
-		lattice.setSitePointers(site_ptrs);
 		// Perform test initialization
 		coords_creation = { lattice.getLength() / 2, lattice.getWidth() / 2, lattice.getHeight() / 2 };
 		CreationEvent event_creation_new(this);
@@ -66,7 +70,7 @@ public:
 		return true;
 	}
 
-	void calculateNextEvent(Object* object_ptr) {
+	virtual void calculateNextEvent(Object* object_ptr) {
 		auto move_event_it = find_if(events_move.begin(), events_move.end(), [object_ptr](MoveEvent& a) { return a.getObjectPtr() == object_ptr; });
 		move_event_it->calculateExecutionTime(k_move);
 		Coords coords_i = object_ptr->getCoords();
@@ -80,6 +84,10 @@ public:
 		}
 	}
 
+	void addObjects(const vector<Object*>& input_ptrs) {
+		Simulation::addObjects(input_ptrs);
+	}
+
 	bool checkErrorMessageFunctions(string msg_in) {
 		setErrorMessage(msg_in);
 		string msg_out = getErrorMessage();
@@ -103,6 +111,9 @@ public:
 			Object object(getTime(), getN_objects_created(), coords_dest);
 			objects.push_back(object);
 			addObject(&objects.back());
+			if (lattice.isSiteStatesEnabled()) {
+				lattice.setSiteSpecies(lattice.getSiteIndex(coords_dest), 1);
+			}
 			Simulation* sim_ptr = this;
 			MoveEvent event1(sim_ptr);
 			event1.setObjectPtr(&objects.back());
@@ -114,7 +125,7 @@ public:
 		return coords_dest;
 	}
 
-	void executeMoveEvent(const std::list<Event*>::const_iterator event_it) {
+	virtual void executeMoveEvent(const std::list<Event*>::const_iterator event_it) {
 		Event* event_ptr = *event_it;
 		moveObject(event_ptr->getObjectPtr(), event_ptr->getDestCoords());
 		move_counts[event_ptr->getObjectPtr()->getTag()]++;
@@ -185,6 +196,26 @@ public:
 		return lattice.generateRandomCoords();
 	}
 
+	int64_t getSiteIndex(const Coords& coords) const {
+		return lattice.getSiteIndex(coords);
+	}
+
+	uint8_t getSiteSpecies(const Coords& coords) const {
+		return lattice.getSiteSpecies(lattice.getSiteIndex(coords));
+	}
+
+	bool isOccupied(const Coords& coords) const {
+		return lattice.isOccupied(coords);
+	}
+
+	using Simulation::moveObject;
+
+	using Simulation::updateObjectStore;
+
+	void removeAllObjects() {
+		Simulation::removeAllObjects();
+	}
+
 	void removeEvent(Event* event_ptr) {
 		Simulation::removeEvent(event_ptr);
 	}
@@ -193,12 +224,40 @@ public:
 		Simulation::removeObject(object_ptr);
 	}
 
+	void removeObjects(const vector<Object*>& input_ptrs) {
+		Simulation::removeObjects(input_ptrs);
+	}
+
 	void resetErrorStatus() {
 		Error_found = false;
 		error_msg = "";
 	}
 };
 
+// Derived test simulation class that calculates and executes the move events using site indices
+class TestSimIndexed : public TestSim {
+public:
+	void calculateNextEvent(Object* object_ptr) {
+		auto move_event_it = find_if(events_move.begin(), events_move.end(), [object_ptr](MoveEvent& a) { return a.getObjectPtr() == object_ptr; });
+		move_event_it->calculateExecutionTime(k_move);
+		int64_t site_index_f = lattice.chooseRandomUnoccupiedNeighbor(object_ptr->getSiteIndex());
+		if (site_index_f == -1) {
+			setObjectEvent(object_ptr, nullptr);
+		}
+		else {
+			move_event_it->setDestCoords(lattice.getSiteCoords(site_index_f), site_index_f);
+			setObjectEvent(object_ptr, &(*move_event_it));
+		}
+	}
+
+	void executeMoveEvent(const std::list<Event*>::const_iterator event_it) {
+		Event* event_ptr = *event_it;
+		moveObject(event_ptr->getObjectPtr(), event_ptr->getDestCoords(), event_ptr->getDestSiteIndex());
+		move_counts[event_ptr->getObjectPtr()->getTag()]++;
+		N_move_events++;
+	}
+};
+
 namespace SimulationTests {
 
 	class SimulationTest : public ::testing::Test {
@@ -267,6 +326,20 @@ namespace SimulationTests {
 		params.Enable_selective_recalc = true;
 		params.Recalc_cutoff = 0;
 		EXPECT_FALSE(params.checkParameters());
+		// Check for invalid mean squared displacement sample times when the accumulator is enabled
+		params = params_base;
+		params.Enable_msd_accumulator = true;
+		params.MSD_time_min = 1e-3;
+		params.MSD_time_max = 1e-1;
+		params.MSD_bins_per_decade = 4;
+		EXPECT_TRUE(params.checkParameters());
+		params.MSD_time_min = 0.0;
+		EXPECT_FALSE(params.checkParameters());
+		params.MSD_time_min = 1.0;
+		EXPECT_FALSE(params.checkParameters());
+		params.MSD_time_min = 1e-3;
+		params.MSD_bins_per_decade = 0;
+		EXPECT_FALSE(params.checkParameters());
 		// Check for missing logfile when logging is enabled
 		params = params_base;
 		params.Enable_logging = true;
@@ -303,6 +376,58 @@ namespace SimulationTests {
 		sim.resetErrorStatus();
 	}
 
+	TEST_F(SimulationTest, BulkObjectTests) {
+		// Add objects at distinct sites in one call
+		vector<Object*> object_ptrs;
+		for (int n = 0; n < 1000; n++) {
+			sim.objects.push_back(Object(0.0, n, Coords(n % 200, (7 * n) % 200, n / 200)));
+			object_ptrs.push_back(&sim.objects.back());
+		}
+		sim.addObjects(object_ptrs);
+		EXPECT_EQ(1000, sim.getN_objects_created());
+		EXPECT_EQ(1001, (int)sim.getAllEventPtrs().size());
+		EXPECT_TRUE(sim.getAllObjectPtrs() == object_ptrs);
+		for (auto const &item : sim.objects) {
+			EXPECT_TRUE(sim.isOccupied(item.getCoords()));
+		}
+		// Check that the event list entries are linked to the objects
+		Event event1(&sim);
+		*(object_ptrs[501]->getEventIt()) = &event1;
+		auto event_ptrs = sim.getAllEventPtrs();
+		EXPECT_EQ(1, count(event_ptrs.begin(), event_ptrs.end(), &event1));
+		// Remove every other object in one call
+		vector<Object*> removed_ptrs;
+		for (int n = 0; n < 1000; n += 2) {
+			removed_ptrs.push_back(object_ptrs[n]);
+		}
+		long int N_events_executed = sim.getN_events_executed();
+		// Duplicate pointers are only removed and counted once
+		removed_ptrs.push_back(object_ptrs[0]);
+		sim.removeObjects(removed_ptrs);
+		removed_ptrs.pop_back();
+		EXPECT_FALSE(sim.getErrorStatus());
+		EXPECT_EQ(N_events_executed + 500, sim.getN_events_executed());
+		EXPECT_EQ(500, (int)sim.getAllObjectPtrs().size());
+		EXPECT_EQ(501, (int)sim.getAllEventPtrs().size());
+		event_ptrs = sim.getAllEventPtrs();
+		EXPECT_EQ(1, count(event_ptrs.begin(), event_ptrs.end(), &event1));
+		for (int n = 0; n < 1000; n++) {
+			EXPECT_EQ(n % 2 == 1, sim.isOccupied(object_ptrs[n]->getCoords()));
+		}
+		// Check that removing objects that are not in the simulation sets the error status
+		sim.removeObjects(removed_ptrs);
+		EXPECT_TRUE(sim.getErrorStatus());
+		EXPECT_EQ(N_events_executed + 500, sim.getN_events_executed());
+		sim.resetErrorStatus();
+		// Remove the remaining objects
+		sim.removeAllObjects();
+		EXPECT_TRUE(sim.getAllObjectPtrs().empty());
+		EXPECT_EQ(1, (int)sim.getAllEventPtrs().size());
+		for (auto const &item : sim.objects) {
+			EXPECT_FALSE(sim.isOccupied(item.getCoords()));
+		}
+	}
+
 	TEST_F(SimulationTest, BKL_determinePathwayTests) {
 		// Construct list of events and event pointers that all have the same rate constant
 		Event event1(&sim);
@@ -418,6 +543,249 @@ namespace SimulationTests {
 		}
 	}
 
+	TEST_F(SimulationTest, SiteIndexTests) {
+		// Check that the object site index is set when the object is added
+		sim.objects.push_back(Object(0.0, 0, Coords(0, 0, 0)));
+		Object* object_ptr = &sim.objects.back();
+		sim.addObjects(vector<Object*>{ object_ptr });
+		EXPECT_EQ(0, object_ptr->getSiteIndex());
+		// Move the object across a periodic boundary using the site index version
+		int64_t site_index = sim.getSiteIndex(Coords(199, 0, 0));
+		sim.moveObject(object_ptr, site_index);
+		EXPECT_EQ(Coords(199, 0, 0), object_ptr->getCoords());
+		EXPECT_EQ(site_index, object_ptr->getSiteIndex());
+		EXPECT_DOUBLE_EQ(-1.0, object_ptr->calculateDisplacement(1));
+		EXPECT_TRUE(sim.isOccupied(Coords(199, 0, 0)));
+		EXPECT_FALSE(sim.isOccupied(Coords(0, 0, 0)));
+		// Move the object using both the coordinates and the site index
+		site_index = sim.getSiteIndex(Coords(199, 199, 0));
+		sim.moveObject(object_ptr, Coords(199, 199, 0), site_index);
+		EXPECT_EQ(site_index, object_ptr->getSiteIndex());
+		EXPECT_DOUBLE_EQ(-1.0, object_ptr->calculateDisplacement(2));
+		EXPECT_TRUE(sim.isOccupied(Coords(199, 199, 0)));
+		EXPECT_FALSE(sim.isOccupied(Coords(199, 0, 0)));
+		// Move the object using the coordinates version
+		sim.moveObject(object_ptr, Coords(199, 199, 199));
+		EXPECT_EQ(sim.getSiteIndex(Coords(199, 199, 199)), object_ptr->getSiteIndex());
+		EXPECT_FALSE(sim.isOccupied(Coords(199, 199, 0)));
+		// Check that the coordinates version still rejects destination coordinates outside of the lattice
+		EXPECT_THROW(sim.moveObject(object_ptr, Coords(200, 199, 199)), out_of_range);
+		EXPECT_THROW(sim.moveObject(object_ptr, Coords(0, -1, 0)), out_of_range);
+		EXPECT_EQ(Coords(199, 199, 199), object_ptr->getCoords());
+		EXPECT_TRUE(sim.isOccupied(Coords(199, 199, 199)));
+		sim.removeObject(object_ptr);
+		EXPECT_FALSE(sim.isOccupied(Coords(199, 199, 199)));
+	}
+
+	TEST_F(SimulationTest, ObjectStoreTests) {
+		// Check that the object store matches the objects and the object list throughout a random walk with periodic boundaries
+		sim.N_tests = 200;
+		sim.N_steps = 2000;
+		const ObjectStore& store = sim.getObjectStore();
+		while (!sim.checkFinished()) {
+			EXPECT_TRUE(sim.executeNextEvent());
+			auto object_ptrs = sim.getAllObjectPtrs();
+			ASSERT_EQ((int64_t)object_ptrs.size(), store.size());
+			EXPECT_TRUE(store.getObjectPtrs() == object_ptrs);
+		}
+		EXPECT_GT(store.size(), 0);
+		double msd = 0.0;
+		int64_t i = 0;
+		for (auto const &item : store.getObjectPtrs()) {
+			EXPECT_EQ(i, item->getStoreIndex());
+			EXPECT_EQ(item->getCoords(), Coords(store.getX()[i], store.getY()[i], store.getZ()[i]));
+			EXPECT_DOUBLE_EQ(item->calculateDisplacement(1), store.getNetX()[i]);
+			EXPECT_DOUBLE_EQ(item->calculateDisplacement(2), store.getNetY()[i]);
+			EXPECT_DOUBLE_EQ(item->calculateDisplacement(3), store.getNetZ()[i]);
+			EXPECT_EQ(item->getTag(), store.getTags()[i]);
+			msd += item->calculateDisplacement()*item->calculateDisplacement();
+			i++;
+		}
+		EXPECT_NEAR(msd / store.size(), store.calculateMeanSquaredDisplacement(), 1e-9);
+		// Check that an object changed outside of the moveObject functions is copied into the store
+		Object* object_ptr = store.getObjectPtrs()[0];
+		object_ptr->resetInitialCoords(object_ptr->getCoords());
+		EXPECT_EQ(0.0, object_ptr->calculateDisplacement());
+		sim.updateObjectStore(object_ptr);
+		EXPECT_EQ(0, store.getNetX()[0]);
+		EXPECT_EQ(0, store.getNetY()[0]);
+		EXPECT_EQ(0, store.getNetZ()[0]);
+		sim.removeAllObjects();
+		EXPECT_EQ(0, store.size());
+	}
+
+	TEST_F(SimulationTest, MSDAccumulatorTests) {
+		// Check that the accumulator is empty when it is disabled
+		EXPECT_EQ(0, sim.getMSDAccumulator().getNumSampleTimes());
+		params_base.Enable_msd_accumulator = true;
+		params_base.MSD_time_min = 1e-3;
+		params_base.MSD_time_max = 0.2;
+		params_base.MSD_bins_per_decade = 4;
+		TestSim sim2;
+		sim2.init(params_base);
+		sim2.N_tests = 1000;
+		sim2.N_steps = 500;
+		sim2.k_move = 1000;
+		sim2.setGeneratorSeed(std::random_device{}());
+		while (!sim2.checkFinished()) {
+			EXPECT_TRUE(sim2.executeNextEvent());
+		}
+		sim2.updateMSDAccumulator();
+		const MSDAccumulator& accumulator = sim2.getMSDAccumulator();
+		ASSERT_EQ(10, accumulator.getNumSampleTimes());
+		auto counts = accumulator.getSampleCounts();
+		EXPECT_GE(counts[0], counts.back());
+		EXPECT_GT(counts.back(), 900);
+		// Each isolated object hops a distance of one lattice unit with a rate of k_move, so the mean squared displacement is k_move * t
+		auto msd_data = accumulator.calculateMeanSquaredDisplacements();
+		ASSERT_EQ(10, (int)msd_data.size());
+		for (auto const &item : msd_data) {
+			EXPECT_NEAR(1.0, item.second / (sim2.k_move * item.first), 0.15);
+		}
+		auto diffusion_data = accumulator.calculateDiffusionCoefficients(params_base.Params_lattice.Unit_size, 3);
+		EXPECT_NEAR(sim2.k_move * 1e-14 / 6.0, diffusion_data.back().second, 0.15 * sim2.k_move * 1e-14 / 6.0);
+		// Check that moving an object that is not in the object store throws an exception without changing the lattice
+		TestSim sim3;
+		sim3.init(params_base);
+		Object object(0.0, 0, Coords(0, 0, 0));
+		EXPECT_THROW(sim3.moveObject(&object, Coords(1, 0, 0)), invalid_argument);
+		EXPECT_EQ(Coords(0, 0, 0), object.getCoords());
+		EXPECT_FALSE(sim3.isOccupied(Coords(1, 0, 0)));
+	}
+
+	TEST_F(SimulationTest, Rand01Tests) {
+		// Check the range and mean of the buffered random numbers over several buffer refills
+		sim.setGeneratorSeed(42);
+		vector<double> numbers(1000);
+		double sum = 0.0;
+		for (auto &item : numbers) {
+			item = sim.rand01();
+			EXPECT_GT(item, 0.0);
+			EXPECT_LE(item, 1.0);
+			sum += item;
+		}
+		EXPECT_NEAR(0.5, sum / numbers.size(), 0.05);
+		// Check that setting the seed discards the buffered numbers and restarts the sequence
+		sim.rand01();
+		sim.setGeneratorSeed(42);
+		for (auto const &item : numbers) {
+			EXPECT_DOUBLE_EQ(item, sim.rand01());
+		}
+		// Check that the buffered numbers match the block generation from the same generator state
+		sim.setGeneratorSeed(42);
+		vector<double> block(numbers.size());
+		sim.generateRand01Block(block);
+		EXPECT_EQ(numbers, block);
+	}
+
+	TEST_F(SimulationTest, RandExpTests) {
+		// Check that the buffered numbers match the block generation from the same generator state
+		sim.setGeneratorSeed(7);
+		vector<double> numbers(1024);
+		for (auto &item : numbers) {
+			item = sim.randExp();
+			EXPECT_GE(item, 0.0);
+		}
+		sim.setGeneratorSeed(7);
+		vector<double> block(numbers.size());
+		sim.generateRandExpBlock(block);
+		EXPECT_EQ(numbers, block);
+		// Check that setting the seed discards the buffered numbers
+		sim.setGeneratorSeed(7);
+		sim.randExp();
+		sim.setGeneratorSeed(7);
+		EXPECT_DOUBLE_EQ(numbers[0], sim.randExp());
+		EXPECT_NEAR(1.0, vector_avg(numbers), 0.1);
+	}
+
+	TEST_F(SimulationTest, RandomStreamTests) {
+		Parameters_Simulation params = params_base;
+		params.Params_lattice.Length = 10;
+		params.Params_lattice.Width = 10;
+		params.Params_lattice.Height = 10;
+		params.Random_seed = 12345;
+		// Check that simulations with the same seed and ID number reproduce the same random numbers
+		TestSim sim1, sim2, sim3;
+		sim1.init(params, 0);
+		sim2.init(params, 0);
+		sim3.init(params, 1);
+		EXPECT_EQ(12345ULL, sim1.getRunSeed());
+		EXPECT_EQ(Simulation::calculateStreamKey(12345, 0), sim1.getStreamKey());
+		EXPECT_EQ(sim1.getStreamKey(), sim2.getStreamKey());
+		for (int n = 0; n < 1000; n++) {
+			EXPECT_DOUBLE_EQ(sim1.rand01(), sim2.rand01());
+		}
+		// Check that different ID numbers and consecutive seeds result in different keys
+		EXPECT_NE(sim1.getStreamKey(), sim3.getStreamKey());
+		vector<uint64_t> keys;
+		for (int seed = 1; seed <= 10; seed++) {
+			for (int id = 0; id < 10; id++) {
+				keys.push_back(Simulation::calculateStreamKey(seed, id));
+			}
+		}
+		sort(keys.begin(), keys.end());
+		EXPECT_TRUE(adjacent_find(keys.begin(), keys.end()) == keys.end());
+		// Check that the object streams do not depend on the order in which the objects draw random numbers
+		Object object1(0.0, 1, Coords(0, 0, 0));
+		Object object2(0.0, 2, Coords(1, 0, 0));
+		vector<double> numbers1, numbers2;
+		for (int n = 0; n < 100; n++) {
+			numbers1.push_back(sim1.rand01(&object1));
+		}
+		for (int n = 0; n < 100; n++) {
+			numbers2.push_back(sim1.rand01(&object2));
+		}
+		EXPECT_EQ(100ULL, object1.getRandomCounter());
+		Object object1_copy(0.0, 1, Coords(0, 0, 0));
+		Object object2_copy(0.0, 2, Coords(1, 0, 0));
+		for (int n = 0; n < 100; n++) {
+			EXPECT_DOUBLE_EQ(numbers2[n], sim2.rand01(&object2_copy));
+			EXPECT_DOUBLE_EQ(numbers1[n], sim2.rand01(&object1_copy));
+		}
+		EXPECT_NE(numbers1, numbers2);
+		// Check that the stream blocks match the Philox4x32 generator with the stream key
+		uint32_t block1[4];
+		uint32_t block2[4];
+		sim1.generateStreamBlock(7, 3, block1);
+		Philox4x32::generateBlock(sim1.getStreamKey(), 3, 7, block2);
+		for (int n = 0; n < 4; n++) {
+			EXPECT_EQ(block2[n], block1[n]);
+		}
+		// Check that processors with different ID numbers draw different object streams
+		Object object1_rank1(0.0, 1, Coords(0, 0, 0));
+		EXPECT_NE(numbers1[0], sim3.rand01(&object1_rank1));
+		// Check that setting the seed updates the run seed and the stream key
+		sim3.setGeneratorSeed(12345);
+		EXPECT_EQ(12345ULL, sim3.getRunSeed());
+		EXPECT_EQ(Simulation::calculateStreamKey(12345, 1), sim3.getStreamKey());
+		// Check that a run seed is selected when no seed is set
+		params.Random_seed = 0;
+		sim2.init(params, 0);
+		EXPECT_NE(0ULL, sim2.getRunSeed());
+	}
+
+	TEST_F(SimulationTest, SiteStatesTests) {
+		// Check that the occupant species codes move with the objects
+		params_base.Params_lattice.Length = 50;
+		params_base.Params_lattice.Width = 50;
+		params_base.Params_lattice.Height = 50;
+		params_base.Params_lattice.Enable_site_states = true;
+		TestSim sim2;
+		sim2.init(params_base);
+		sim2.N_tests = 1000;
+		sim2.N_steps = 100;
+		sim2.k_move = 1000;
+		while (!sim2.checkFinished()) {
+			EXPECT_TRUE(sim2.executeNextEvent());
+			if (sim2.event_previous_type.compare("Move") == 0) {
+				EXPECT_EQ(1, sim2.getSiteSpecies(sim2.event_previous.getDestCoords()));
+			}
+			for (auto const &item : sim2.objects) {
+				EXPECT_EQ(1, sim2.getSiteSpecies(item.getCoords()));
+			}
+		}
+	}
+
 	TEST_F(SimulationTest, 3DRandomWalkTests) {
 		// 3D
 		while (!sim.checkFinished()) {
@@ -433,6 +801,52 @@ namespace SimulationTests {
 		EXPECT_NEAR(expected_val, displacement, 3e-2*expected_val);
 	}
 
+	TEST_F(SimulationTest, SiteIndexRandomWalkTests) {
+		// 3D random walk where the move events are calculated and executed using site indices
+		TestSimIndexed sim_indexed;
+		sim_indexed.init(params_base);
+		sim_indexed.N_tests = 5000;
+		sim_indexed.N_steps = 500;
+		sim_indexed.k_move = 1000;
+		while (!sim_indexed.checkFinished()) {
+			EXPECT_TRUE(sim_indexed.executeNextEvent());
+			if (sim_indexed.event_previous.getEventType().compare("Move") == 0) {
+				Object* object_ptr = sim_indexed.event_previous.getObjectPtr();
+				EXPECT_EQ(sim_indexed.event_previous.getDestCoords(), object_ptr->getCoords());
+				EXPECT_EQ(sim_indexed.event_previous.getDestSiteIndex(), object_ptr->getSiteIndex());
+				EXPECT_EQ(sim_indexed.getSiteIndex(object_ptr->getCoords()), object_ptr->getSiteIndex());
+			}
+		}
+		double displacement = vector_avg(sim_indexed.displacement_data);
+		double dim = 3.0;
+		double expected_val = sqrt(2.0 * sim_indexed.N_steps / dim)*(tgamma((dim + 1.0) / 2.0) / tgamma(dim / 2.0));
+		EXPECT_NEAR(expected_val, displacement, 3e-2*expected_val);
+	}
+
+	TEST_F(SimulationTest, SparseRandomWalkTests) {
+		// 3D random walk on a large lattice that would not fit in memory without sparse storage
+		params_base.Params_lattice.Length = 1000;
+		params_base.Params_lattice.Width = 1000;
+		params_base.Params_lattice.Height = 1000;
+		params_base.Params_lattice.Enable_sparse_storage = true;
+		TestSim sim_sparse;
+		sim_sparse.init(params_base);
+		EXPECT_TRUE(sim_sparse.sites.empty());
+		sim_sparse.N_tests = 5000;
+		sim_sparse.N_steps = 500;
+		sim_sparse.k_move = 1000;
+		while (!sim_sparse.checkFinished()) {
+			EXPECT_TRUE(sim_sparse.executeNextEvent());
+			if (sim_sparse.event_previous.getEventType().compare("Move") == 0) {
+				EXPECT_EQ(sim_sparse.event_previous.getDestCoords(), sim_sparse.event_previous.getObjectPtr()->getCoords());
+			}
+		}
+		double displacement = vector_avg(sim_sparse.displacement_data);
+		double dim = 3.0;
+		double expected_val = sqrt(2.0 * sim_sparse.N_steps / dim)*(tgamma((dim + 1.0) / 2.0) / tgamma(dim / 2.0));
+		EXPECT_NEAR(expected_val, displacement, 3e-2*expected_val);
+	}
+
 	TEST_F(SimulationTest, 2DRandomWalkTests) {
 		// 2D
 		params_base.Params_lattice.Enable_periodic_x = true;
@@ -627,7 +1041,7 @@ namespace UtilsTests {
 		// Test with empty int data set that exception is thrown
 		EXPECT_THROW(calculateProbabilityHist(int_data, 5), invalid_argument);
 		// Generate a set of data from a uniform real distribution
-		mt19937_64 gen(std::random_device{}());
+		RandomEngine gen(std::random_device{}());
 		uniform_real_distribution<double> dist(0, 100);
 		vector<double> data((int)3e7);
 		generate(data.begin(), data.end(), [&]() { return dist(gen); });
@@ -837,10 +1251,19 @@ namespace UtilsTests {
 		EXPECT_EQ(5, (int)prob_hist.size());
 		prob_hist = calculateProbabilityHist(data_float, 0.1);
 		EXPECT_EQ(5, (int)prob_hist.size());
+		// Check that data without any finite values throws an exception
+		data = { NAN, INFINITY, -INFINITY };
+		EXPECT_THROW(calculateProbabilityHist(data, 10), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHist(data, 0.1), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHist(data, 0.1, 10), invalid_argument);
+		data_float = { NAN, INFINITY };
+		EXPECT_THROW(calculateProbabilityHist(data_float, 10), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHist(data_float, 0.1), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHist(data_float, 0.1, 10), invalid_argument);
 	}
 
 	TEST(UtilsTests, ExponentialDOSTests) {
-		mt19937_64 gen(std::random_device{}());
+		RandomEngine gen(std::random_device{}());
 		// Check double version
 		vector<double> data((int)2e7, 0.0);
 		createExponentialDOSVector(data, 0.0, 0.1, gen);
@@ -872,7 +1295,7 @@ namespace UtilsTests {
 	}
 
 	TEST(UtilsTests, GaussianDOSTests) {
-		mt19937_64 gen(std::random_device{}());
+		RandomEngine gen(std::random_device{}());
 		// Check double version
 		vector<double> data((int)2e7, 0.0);
 		createGaussianDOSVector(data, 0.0, 0.15, gen);
@@ -911,6 +1334,90 @@ namespace UtilsTests {
 		EXPECT_NEAR(expected_height, peak_height, 2e-2*expected_height);
 	}
 
+	TEST(UtilsTests, ParallelDOSTests) {
+		// Check that the Gaussian data does not depend on the number of threads
+		vector<double> data((int)2e7, 0.0);
+		createGaussianDOSVector(data, 0.0, 0.15, 12345, 4);
+		EXPECT_NEAR(0.0, vector_avg(data), 1e-4);
+		EXPECT_NEAR(0.15, vector_stdev(data), 1e-4);
+		vector<double> data2(1000, 0.0);
+		createGaussianDOSVector(data2, 0.0, 0.15, 12345, 1);
+		EXPECT_TRUE(equal(data2.begin(), data2.end(), data.begin()));
+		createGaussianDOSVector(data2, 0.0, 0.15, 54321, 3);
+		EXPECT_FALSE(equal(data2.begin(), data2.end(), data.begin()));
+		vector<float> data_float(1000, 0.0f);
+		createGaussianDOSVector(data_float, 0.0, 0.15, 12345, 7);
+		for (int n = 0; n < 1000; n++) {
+			EXPECT_FLOAT_EQ((float)data[n], data_float[n]);
+		}
+		// Check the exponential data against the expected peak height
+		createExponentialDOSVector(data, 0.0, 0.1, 12345, 0);
+		auto prob_dist = calculateDensityHist(calculateProbabilityHist(data, 1000));
+		EXPECT_NEAR(1.0, integrateData(prob_dist), 1e-4);
+		double peak_height = max_element(prob_dist.begin(), prob_dist.end(), [](pair<double, double> a, pair<double, double> b) {
+			return a.second < b.second;
+		})->second;
+		double expected_height = 0.5*(1.0 / 0.1);
+		EXPECT_NEAR(expected_height, peak_height, 1e-2*expected_height);
+		data2.assign(1000, 0.0);
+		createExponentialDOSVector(data2, 0.0, 0.1, 12345, 2);
+		EXPECT_TRUE(equal(data2.begin(), data2.end(), data.begin()));
+		createExponentialDOSVector(data_float, 0.0, 0.1, 12345, 5);
+		for (int n = 0; n < 1000; n++) {
+			EXPECT_FLOAT_EQ((float)data[n], data_float[n]);
+		}
+	}
+
+	TEST(UtilsTests, ParallelForTests) {
+		// Check that every index is visited exactly once for several thread counts
+		for (int num_threads : { 0, 1, 3, 8, 200 }) {
+			vector<int> counts(101, 0);
+			parallelFor(0, 101, num_threads, [&counts](const int64_t index_start, const int64_t index_end) {
+				for (int64_t n = index_start; n < index_end; n++) {
+					counts[n]++;
+				}
+			});
+			EXPECT_EQ(101, count(counts.begin(), counts.end(), 1));
+		}
+		// Check that an empty range does not call the function
+		bool called = false;
+		parallelFor(5, 5, 4, [&called](const int64_t, const int64_t) { called = true; });
+		EXPECT_FALSE(called);
+		// Check that exceptions are passed back to the calling thread
+		EXPECT_THROW(parallelFor(0, 100, 4, [](const int64_t index_start, const int64_t) {
+			if (index_start == 0) {
+				throw runtime_error("Test exception");
+			}
+		}), runtime_error);
+	}
+
+	TEST(UtilsTests, ParallelProbabilityHistTests) {
+		// Check that the multithreaded probability histograms are identical to the single-threaded ones for several thread counts
+		vector<double> data(200000);
+		createExponentialDOSVector(data, 0.0, 0.1, 12345, 4);
+		data[10] = NAN;
+		data[100] = INFINITY;
+		vector<float> data_float(data.begin(), data.end());
+		for (int num_threads : { 0, 1, 3, 8 }) {
+			EXPECT_TRUE(calculateProbabilityHist(data, 100) == calculateProbabilityHistParallel(data, 100, num_threads));
+			EXPECT_TRUE(calculateProbabilityHist(data, 0.01) == calculateProbabilityHistParallel(data, 0.01, num_threads));
+			EXPECT_TRUE(calculateProbabilityHist(data, 0.01, 50) == calculateProbabilityHistParallel(data, 0.01, 50, num_threads));
+			EXPECT_TRUE(calculateProbabilityHist(data_float, 100) == calculateProbabilityHistParallel(data_float, 100, num_threads));
+			EXPECT_TRUE(calculateProbabilityHist(data_float, 0.01) == calculateProbabilityHistParallel(data_float, 0.01, num_threads));
+			EXPECT_TRUE(calculateProbabilityHist(data_float, 0.01, 50) == calculateProbabilityHistParallel(data_float, 0.01, 50, num_threads));
+		}
+		// Check that small data vectors with more threads than entries work
+		vector<double> data_small = { 1.0, 2.0, 3.0 };
+		EXPECT_TRUE(calculateProbabilityHist(data_small, 2) == calculateProbabilityHistParallel(data_small, 2, 8));
+		// Check that invalid data throws an exception
+		data_small.clear();
+		EXPECT_THROW(calculateProbabilityHistParallel(data_small, 10, 4), invalid_argument);
+		data_small = { NAN, NAN, INFINITY };
+		EXPECT_THROW(calculateProbabilityHistParallel(data_small, 10, 4), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHistParallel(data_small, 0.1, 4), invalid_argument);
+		EXPECT_THROW(calculateProbabilityHistParallel(data_small, 0.1, 10, 4), invalid_argument);
+	}
+
 	TEST(UtilsTests, Str2boolTests) {
 		EXPECT_TRUE(str2bool("true"));
 		EXPECT_TRUE(str2bool(" true  "));
@@ -1100,11 +1607,269 @@ namespace UtilsTests {
 	}
 }
 
+namespace HistogramTests {
+
+	// Calculates the probability histogram in the same way as the original calculateProbabilityHist function, which copies the
+	// data, removes the values that are not finite, and then bins the remaining data
+	vector<pair<double, double>> calculateProbabilityHistReference(const vector<double>& data, int num_bins) {
+		auto data_filtered = data;
+		data_filtered.erase(remove_if(data_filtered.begin(), data_filtered.end(), [](double val) { return !isfinite(val); }), data_filtered.end());
+		double min_val = *min_element(data_filtered.begin(), data_filtered.end());
+		double max_val = *max_element(data_filtered.begin(), data_filtered.end());
+		if (num_bins > (int)data_filtered.size()) {
+			num_bins = (int)data_filtered.size();
+		}
+		min_val -= 1e-12*abs(min_val);
+		max_val += 1e-12*abs(max_val);
+		double bin_size = (max_val - min_val) / num_bins;
+		vector<pair<double, double>> hist(num_bins, make_pair(0.0, 0.0));
+		for (int i = 0; i < num_bins; i++) {
+			hist[i].first = min_val + 0.5*bin_size + bin_size * i;
+		}
+		vector<int> counts(num_bins, 0);
+		for (auto const &item : data_filtered) {
+			int index = (int)floor((item - min_val) / bin_size);
+			if (index == num_bins) {
+				index--;
+			}
+			counts[index]++;
+		}
+		for (int i = 0; i < num_bins; i++) {
+			hist[i].second = (double)counts[i] / (double)data_filtered.size();
+		}
+		return hist;
+	}
+
+	TEST(HistogramTests, FixedBinsTests) {
+		EXPECT_THROW(Histogram(0.0, 0.0, 10), invalid_argument);
+		EXPECT_THROW(Histogram(0.0, 1.0, 0), invalid_argument);
+		EXPECT_THROW(Histogram(NAN, 1.0, 10), invalid_argument);
+		Histogram hist(-1.0, 0.5, 4);
+		EXPECT_FALSE(hist.isAutoRangeEnabled());
+		EXPECT_EQ(4, hist.getNumBins());
+		EXPECT_DOUBLE_EQ(-1.0, hist.getBinStart());
+		EXPECT_DOUBLE_EQ(0.5, hist.getBinSize());
+		EXPECT_THROW(hist.calculateProbabilityHist(), invalid_argument);
+		// Add samples one at a time and in a batch, including samples at the bin edges, out of range, and not finite
+		hist.addSample(-1.0);
+		hist.addSample(-0.75);
+		hist.addSample(1.0);
+		hist.addSamples(vector<double>{ -0.5, 0.25, NAN, 2.0, -1.5, INFINITY });
+		hist.addSamples(vector<float>{ 0.75f, 0.5f });
+		EXPECT_EQ(9, hist.getNumSamples());
+		EXPECT_EQ(2, hist.getNumInvalidSamples());
+		EXPECT_EQ(2, hist.getNumOutOfRangeSamples());
+		vector<int64_t> counts_expected = { 2, 1, 1, 3 };
+		EXPECT_TRUE(hist.getCounts() == counts_expected);
+		auto prob_hist = hist.calculateProbabilityHist();
+		ASSERT_EQ(4, (int)prob_hist.size());
+		EXPECT_DOUBLE_EQ(-0.75, prob_hist[0].first);
+		EXPECT_DOUBLE_EQ(0.75, prob_hist[3].first);
+		EXPECT_DOUBLE_EQ(2.0 / 9.0, prob_hist[0].second);
+		EXPECT_DOUBLE_EQ(3.0 / 9.0, prob_hist[3].second);
+		// Check that samples just above the upper edge of the last bin are out of range
+		hist.addSample(1.4);
+		hist.addSample(nextafter(1.0, 2.0));
+		EXPECT_EQ(11, hist.getNumSamples());
+		EXPECT_EQ(4, hist.getNumOutOfRangeSamples());
+		EXPECT_TRUE(hist.getCounts() == counts_expected);
+		// Check that the maximum value is binned when the range is much smaller than the magnitude of the data
+		auto prob_hist_float = calculateProbabilityHist(vector<float>{ 1000.0f, 1000.25f, 1000.5f, 1000.75f }, 3);
+		ASSERT_EQ(3, (int)prob_hist_float.size());
+		EXPECT_DOUBLE_EQ(0.25, prob_hist_float[0].second);
+		EXPECT_DOUBLE_EQ(0.25, prob_hist_float[1].second);
+		EXPECT_DOUBLE_EQ(0.5, prob_hist_float[2].second);
+		// Check that the fixed bins reproduce the original copy-and-bin implementation of the probability histogram functions
+		RandomEngine gen(12345);
+		vector<double> data(100000);
+		createGaussianDOSVector(data, 0.0, 0.05, gen);
+		data[10] = NAN;
+		data[20] = -INFINITY;
+		double min_val = 0.0;
+		double max_val = 0.0;
+		EXPECT_EQ(99998, Histogram::calculateRange(data, min_val, max_val));
+		auto data_filtered = data;
+		data_filtered.erase(remove_if(data_filtered.begin(), data_filtered.end(), [](double val) { return !isfinite(val); }), data_filtered.end());
+		EXPECT_DOUBLE_EQ(*min_element(data_filtered.begin(), data_filtered.end()), min_val);
+		EXPECT_DOUBLE_EQ(*max_element(data_filtered.begin(), data_filtered.end()), max_val);
+		auto prob_hist_ref = calculateProbabilityHistReference(data, 50);
+		auto prob_hist2 = calculateProbabilityHist(data, 50);
+		ASSERT_EQ(prob_hist_ref.size(), prob_hist2.size());
+		for (int i = 0; i < (int)prob_hist_ref.size(); i++) {
+			EXPECT_DOUBLE_EQ(prob_hist_ref[i].first, prob_hist2[i].first);
+			EXPECT_DOUBLE_EQ(prob_hist_ref[i].second, prob_hist2[i].second);
+		}
+		// Check a small data set against fixed expected values
+		prob_hist2 = calculateProbabilityHist(vector<double>{ 0.0, 1.0, 2.0, 3.0, 4.0, NAN }, 2);
+		ASSERT_EQ(2, (int)prob_hist2.size());
+		EXPECT_NEAR(1.0, prob_hist2[0].first, 1e-9);
+		EXPECT_NEAR(3.0, prob_hist2[1].first, 1e-9);
+		// The upper edge of the range is extended slightly, so the value at the center of the range is placed in the first bin
+		EXPECT_DOUBLE_EQ(0.6, prob_hist2[0].second);
+		EXPECT_DOUBLE_EQ(0.4, prob_hist2[1].second);
+	}
+
+	TEST(HistogramTests, AutoRangeTests) {
+		EXPECT_THROW(Histogram(-1.0), invalid_argument);
+		Histogram hist(0.5);
+		EXPECT_TRUE(hist.isAutoRangeEnabled());
+		EXPECT_EQ(0, hist.getNumBins());
+		// The bins are aligned to the first sample and extended in both directions as needed
+		hist.addSample(1.0);
+		EXPECT_EQ(1, hist.getNumBins());
+		EXPECT_DOUBLE_EQ(1.0, hist.getBinStart());
+		hist.addSamples(vector<double>{ 2.2, 1.4, NAN });
+		EXPECT_EQ(3, hist.getNumBins());
+		hist.addSample(-0.1);
+		EXPECT_EQ(6, hist.getNumBins());
+		EXPECT_DOUBLE_EQ(-0.5, hist.getBinStart());
+		EXPECT_EQ(4, hist.getNumSamples());
+		EXPECT_EQ(1, hist.getNumInvalidSamples());
+		EXPECT_EQ(0, hist.getNumOutOfRangeSamples());
+		vector<int64_t> counts_expected = { 1, 0, 0, 2, 0, 1 };
+		EXPECT_TRUE(hist.getCounts() == counts_expected);
+		auto bin_centers = hist.getBinCenters();
+		EXPECT_DOUBLE_EQ(-0.25, bin_centers[0]);
+		EXPECT_DOUBLE_EQ(2.25, bin_centers[5]);
+		auto prob_hist = hist.calculateProbabilityHist();
+		EXPECT_DOUBLE_EQ(0.5, prob_hist[3].second);
+		double prob_sum = 0.0;
+		for (auto const &item : prob_hist) {
+			prob_sum += item.second;
+		}
+		EXPECT_DOUBLE_EQ(1.0, prob_sum);
+	}
+
+	TEST(HistogramTests, MergeTests) {
+		// Check that fixed bins are merged and that histograms with different bins cannot be merged
+		Histogram hist(0.0, 1.0, 3);
+		hist.addSamples(vector<double>{ 0.5, 2.5, 4.0 });
+		Histogram hist2(0.0, 1.0, 3);
+		hist2.addSamples(vector<double>{ 0.2, 1.5, NAN });
+		hist.merge(hist2);
+		vector<int64_t> counts_expected = { 2, 1, 1 };
+		EXPECT_TRUE(hist.getCounts() == counts_expected);
+		EXPECT_EQ(5, hist.getNumSamples());
+		EXPECT_EQ(1, hist.getNumInvalidSamples());
+		EXPECT_EQ(1, hist.getNumOutOfRangeSamples());
+		EXPECT_THROW(hist.merge(Histogram(0.0, 1.0, 4)), invalid_argument);
+		EXPECT_THROW(hist.merge(Histogram(0.5, 1.0, 3)), invalid_argument);
+		EXPECT_THROW(hist.merge(Histogram(1.0)), invalid_argument);
+		// Check that automatic range bins aligned to the same origin are extended and merged
+		Histogram hist_auto(1.0);
+		Histogram hist_auto2(1.0);
+		hist_auto.merge(hist_auto2);
+		EXPECT_EQ(0, hist_auto.getNumBins());
+		hist_auto.addSamples(vector<double>{ 0.0, 2.5 });
+		hist_auto2.merge(hist_auto);
+		hist_auto2.addSamples(vector<double>{ -1.5, 4.0 });
+		hist_auto.merge(hist_auto2);
+		counts_expected = { 1, 0, 2, 0, 2, 0, 1 };
+		EXPECT_TRUE(hist_auto.getCounts() == counts_expected);
+		EXPECT_DOUBLE_EQ(-2.0, hist_auto.getBinStart());
+		Histogram hist_auto3(1.0);
+		hist_auto3.addSample(0.5);
+		EXPECT_THROW(hist_auto.merge(hist_auto3), invalid_argument);
+		// Check that the multithreaded functions give the same results as the single-threaded functions
+		vector<float> data(100001);
+		createGaussianDOSVector(data, 0.0, 0.1, 12345, 4);
+		data[0] = NAN;
+		data[50000] = -INFINITY;
+		float min_val, max_val, min_val2, max_val2;
+		int64_t num_finite = Histogram::calculateRange(data, min_val, max_val);
+		Histogram hist_serial(-0.3, 0.01, 60);
+		hist_serial.addSamples(data);
+		for (int num_threads : { 0, 2, 7 }) {
+			EXPECT_EQ(num_finite, Histogram::calculateRange(data, min_val2, max_val2, num_threads));
+			EXPECT_EQ(min_val, min_val2);
+			EXPECT_EQ(max_val, max_val2);
+			Histogram hist_parallel(-0.3, 0.01, 60);
+			hist_parallel.addSamples(data, num_threads);
+			EXPECT_TRUE(hist_serial.getCounts() == hist_parallel.getCounts());
+			EXPECT_EQ(hist_serial.getNumSamples(), hist_parallel.getNumSamples());
+			EXPECT_EQ(2, hist_parallel.getNumInvalidSamples());
+			EXPECT_EQ(hist_serial.getNumOutOfRangeSamples(), hist_parallel.getNumOutOfRangeSamples());
+		}
+		// Check that the automatic range mode gives the same bins and counts with multiple threads, including when samples are added later
+		Histogram hist_auto_serial(0.01);
+		hist_auto_serial.addSamples(data);
+		hist_auto_serial.addSamples(vector<double>{ 2.0, -2.0 });
+		for (int num_threads : { 1, 3, 8 }) {
+			Histogram hist_auto_parallel(0.01);
+			hist_auto_parallel.addSamples(data, num_threads);
+			hist_auto_parallel.addSamples(vector<double>{ 2.0, -2.0 }, num_threads);
+			EXPECT_EQ(num_finite + 2, hist_auto_parallel.getNumSamples());
+			EXPECT_EQ(2, hist_auto_parallel.getNumInvalidSamples());
+			EXPECT_EQ(hist_auto_serial.getNumBins(), hist_auto_parallel.getNumBins());
+			EXPECT_DOUBLE_EQ(hist_auto_serial.getBinStart(), hist_auto_parallel.getBinStart());
+			EXPECT_TRUE(hist_auto_serial.getCounts() == hist_auto_parallel.getCounts());
+		}
+		Histogram hist_auto4(0.01);
+		hist_auto4.addSamples(vector<double>(10, NAN), 4);
+		EXPECT_EQ(0, hist_auto4.getNumBins());
+		EXPECT_EQ(10, hist_auto4.getNumInvalidSamples());
+		// Check that a range without finite values does not change the output values
+		vector<double> data_invalid(10, NAN);
+		double min_val3 = 1.0, max_val3 = 2.0;
+		EXPECT_EQ(0, Histogram::calculateRange(data_invalid, min_val3, max_val3, 3));
+		EXPECT_DOUBLE_EQ(1.0, min_val3);
+		EXPECT_DOUBLE_EQ(2.0, max_val3);
+	}
+
+}
+
 namespace LatticeTests {
 
+	// Checks the compile-time periodic boundary functions against a direct search over the periodic images
+	template<bool Periodic_x, bool Periodic_y, bool Periodic_z>
+	void checkStaticPeriodicity(Parameters_Lattice params, RandomEngine& gen) {
+		params.Enable_periodic_x = Periodic_x;
+		params.Enable_periodic_y = Periodic_y;
+		params.Enable_periodic_z = Periodic_z;
+		Lattice lattice;
+		lattice.init(params, &gen);
+		auto calculate_min_image = [](const int delta, const int size, const bool periodic) {
+			int separation = abs(delta);
+			if (periodic) {
+				separation = min(separation, min(abs(delta - size), abs(delta + size)));
+			}
+			return separation;
+		};
+		auto wrap = [](const int coord, const int size, const bool periodic) {
+			return periodic ? (coord + size) % size : coord;
+		};
+		uniform_int_distribution<int> dist(-3, 3);
+		for (int n = 0; n < 1000; n++) {
+			Coords coords_i = lattice.generateRandomCoords();
+			Coords coords_f = lattice.generateRandomCoords();
+			int sep_x = calculate_min_image(coords_f.x - coords_i.x, params.Length, Periodic_x);
+			int sep_y = calculate_min_image(coords_f.y - coords_i.y, params.Width, Periodic_y);
+			int sep_z = calculate_min_image(coords_f.z - coords_i.z, params.Height, Periodic_z);
+			EXPECT_EQ(sep_x*sep_x + sep_y*sep_y + sep_z*sep_z, (lattice.calculateLatticeDistanceSquared<Periodic_x, Periodic_y, Periodic_z>(coords_i, coords_f)));
+			EXPECT_EQ(sep_x*sep_x + sep_y*sep_y + sep_z*sep_z, lattice.calculateLatticeDistanceSquared(coords_i, coords_f));
+			int i = dist(gen);
+			int j = dist(gen);
+			int k = dist(gen);
+			bool is_valid = !(i == 0 && j == 0 && k == 0);
+			is_valid = is_valid && (Periodic_x || (coords_i.x + i >= 0 && coords_i.x + i < params.Length));
+			is_valid = is_valid && (Periodic_y || (coords_i.y + j >= 0 && coords_i.y + j < params.Width));
+			is_valid = is_valid && (Periodic_z || (coords_i.z + k >= 0 && coords_i.z + k < params.Height));
+			EXPECT_EQ(is_valid, (lattice.checkMoveValidity<Periodic_x, Periodic_y, Periodic_z>(coords_i, i, j, k)));
+			EXPECT_EQ(is_valid, lattice.checkMoveValidity(coords_i, i, j, k));
+			if (is_valid) {
+				Coords coords_expected(wrap(coords_i.x + i, params.Length, Periodic_x), wrap(coords_i.y + j, params.Width, Periodic_y), wrap(coords_i.z + k, params.Height, Periodic_z));
+				Coords coords_dest;
+				lattice.calculateDestinationCoords<Periodic_x, Periodic_y, Periodic_z>(coords_i, i, j, k, coords_dest);
+				EXPECT_EQ(coords_expected, coords_dest);
+				lattice.calculateDestinationCoords(coords_i, i, j, k, coords_dest);
+				EXPECT_EQ(coords_expected, coords_dest);
+			}
+		}
+	}
+
 	class LatticeTest : public ::testing::Test {
 	protected:
-		mt19937_64 gen;
+		RandomEngine gen;
 		Parameters_Lattice params_lattice;
 		vector<Site> sites;
 		Lattice lattice;
@@ -1151,7 +1916,7 @@ namespace LatticeTests {
 		EXPECT_EQ(50, lattice.getWidth());
 		EXPECT_EQ(50, lattice.getHeight());
 		EXPECT_DOUBLE_EQ(1.0, lattice.getUnitSize());
-		EXPECT_EQ((long int)50 * 50 * 50, lattice.getNumSites());
+		EXPECT_EQ((int64_t)50 * 50 * 50, lattice.getNumSites());
 		EXPECT_DOUBLE_EQ(125000e-21, lattice.getVolume());
 		// Check that initialization with invalid parameters throws an exception
 		auto params = params_lattice;
@@ -1204,6 +1969,68 @@ namespace LatticeTests {
 		EXPECT_EQ(lattice.calculateDX(coords_i, coords_f), 0);
 		EXPECT_EQ(lattice.calculateDY(coords_i, coords_f), 0);
 		EXPECT_EQ(lattice.calculateDZ(coords_i, coords_f), 0);
+		// Check that the image shift matches the individual adjustment factors
+		params_lattice.Enable_periodic_y = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		for (auto item : { &lattice, &lattice2 }) {
+			for (int n = 0; n < 1000; n++) {
+				coords_i = item->generateRandomCoords();
+				coords_f = item->generateRandomCoords();
+				Coords shift = item->calculateImageShift(coords_i, coords_f);
+				EXPECT_EQ(-item->calculateDX(coords_i, coords_f), shift.x);
+				EXPECT_EQ(-item->calculateDY(coords_i, coords_f), shift.y);
+				EXPECT_EQ(-item->calculateDZ(coords_i, coords_f), shift.z);
+			}
+		}
+	}
+
+	TEST_F(LatticeTest, MoveOccupantTests) {
+		// Check that the fused move gives the same state as clearing and setting the sites with all lattice features enabled
+		params_lattice.Length = 10;
+		params_lattice.Width = 10;
+		params_lattice.Height = 10;
+		params_lattice.Enable_free_site_index = true;
+		params_lattice.Enable_neighbor_counts = true;
+		params_lattice.Enable_site_states = true;
+		Lattice lattice2, lattice3;
+		lattice2.init(params_lattice, &gen);
+		lattice3.init(params_lattice, &gen);
+		vector<Site> sites2, sites3;
+		sites2.resize((size_t)lattice2.getNumSites());
+		sites3.resize((size_t)lattice3.getNumSites());
+		lattice2.setSites(sites2, 1);
+		lattice3.setSites(sites3, 1);
+		vector<Object> objects(100);
+		vector<int64_t> object_indices;
+		for (auto &item : objects) {
+			int64_t site_index = lattice2.getSiteIndex(lattice2.chooseRandomUnoccupiedSite());
+			lattice2.setObjectPtr(site_index, &item);
+			lattice2.setSiteSpecies(site_index, 2);
+			lattice3.setObjectPtr(site_index, &item);
+			lattice3.setSiteSpecies(site_index, 2);
+			object_indices.push_back(site_index);
+		}
+		for (int n = 0; n < 10000; n++) {
+			int i = n % 100;
+			int64_t site_index_dest = lattice2.chooseRandomUnoccupiedNeighbor(object_indices[i]);
+			if (site_index_dest < 0) {
+				continue;
+			}
+			lattice2.moveOccupant(object_indices[i], site_index_dest, &objects[i]);
+			uint8_t species = lattice3.getSiteSpecies(object_indices[i]);
+			lattice3.clearOccupancy(object_indices[i]);
+			lattice3.setObjectPtr(site_index_dest, &objects[i]);
+			lattice3.setSiteSpecies(site_index_dest, species);
+			object_indices[i] = site_index_dest;
+		}
+		EXPECT_EQ(lattice3.getNumUnoccupiedSites(), lattice2.getNumUnoccupiedSites());
+		for (int64_t n = 0; n < lattice2.getNumSites(); n++) {
+			EXPECT_EQ(lattice3.isOccupied(n), lattice2.isOccupied(n));
+			EXPECT_EQ(lattice3.getObjectPtr(n), lattice2.getObjectPtr(n));
+			EXPECT_EQ(lattice3.getSiteSpecies(n), lattice2.getSiteSpecies(n));
+			EXPECT_EQ(lattice3.getNumOccupiedNeighbors(n), lattice2.getNumOccupiedNeighbors(n));
+		}
 	}
 
 	TEST_F(LatticeTest, CheckMoveValidityTests) {
@@ -1277,6 +2104,17 @@ namespace LatticeTests {
 		lattice.setOccupied(Coords(5, 5, 6));
 		Coords coords_new = lattice.chooseRandomUnoccupiedNeighbor(coords);
 		EXPECT_TRUE(coords_new == Coords(-1, -1, -1));
+		EXPECT_EQ(-1, lattice.chooseRandomUnoccupiedNeighbor(lattice.getSiteIndex(coords)));
+		// Check the site index version, including a site on the periodic boundaries
+		lattice.clearOccupancy(Coords(5, 5, 6));
+		EXPECT_EQ(lattice.getSiteIndex(Coords(5, 5, 6)), lattice.chooseRandomUnoccupiedNeighbor(lattice.getSiteIndex(coords)));
+		int64_t site_index = lattice.getSiteIndex(Coords(0, 49, 0));
+		for (auto& item : data) {
+			item = (int)lattice.chooseRandomUnoccupiedNeighbor(site_index);
+			EXPECT_EQ(1, lattice.calculateLatticeDistanceSquared(Coords(0, 49, 0), lattice.getSiteCoords(item)));
+		}
+		removeDuplicates(data);
+		EXPECT_EQ(6, (int)data.size());
 	}
 
 	TEST_F(LatticeTest, 2DTests) {
@@ -1361,6 +2199,656 @@ namespace LatticeTests {
 		EXPECT_EQ(12, lattice.calculateLatticeDistanceSquared(coords_i, coords_f));
 	}
 
+	TEST_F(LatticeTest, StaticPeriodicityTests) {
+		params_lattice.Length = 7;
+		params_lattice.Width = 8;
+		params_lattice.Height = 9;
+		checkStaticPeriodicity<true, true, true>(params_lattice, gen);
+		checkStaticPeriodicity<true, true, false>(params_lattice, gen);
+		checkStaticPeriodicity<true, false, true>(params_lattice, gen);
+		checkStaticPeriodicity<true, false, false>(params_lattice, gen);
+		checkStaticPeriodicity<false, true, true>(params_lattice, gen);
+		checkStaticPeriodicity<false, true, false>(params_lattice, gen);
+		checkStaticPeriodicity<false, false, true>(params_lattice, gen);
+		checkStaticPeriodicity<false, false, false>(params_lattice, gen);
+		// Check the neighbor selection on a periodic-xy slab with non-periodic z boundaries
+		params_lattice.Enable_periodic_z = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		vector<Site> sites((size_t)lattice2.getNumSites());
+		lattice2.setSites(sites, 1);
+		Coords coords_corner(0, 0, 0);
+		lattice2.setOccupied(Coords(6, 0, 0));
+		lattice2.setOccupied(Coords(0, 7, 0));
+		lattice2.setOccupied(Coords(1, 0, 0));
+		for (int n = 0; n < 100; n++) {
+			Coords coords_f = lattice2.chooseRandomUnoccupiedNeighbor<true, true, false>(coords_corner);
+			EXPECT_TRUE(coords_f == Coords(0, 1, 0) || coords_f == Coords(0, 0, 1));
+		}
+		lattice2.setOccupied(Coords(0, 1, 0));
+		lattice2.setOccupied(Coords(0, 0, 1));
+		EXPECT_EQ(Coords(-1, -1, -1), lattice2.chooseRandomUnoccupiedNeighbor(coords_corner));
+	}
+
+	TEST_F(LatticeTest, PowerOfTwoTests) {
+		EXPECT_FALSE(lattice.isPowerOfTwo());
+		// Initialize a lattice with power of two dimensions and non-periodic boundaries in the z-direction
+		params_lattice.Length = 16;
+		params_lattice.Width = 32;
+		params_lattice.Height = 8;
+		params_lattice.Enable_periodic_z = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isPowerOfTwo());
+		// Check the site index and site coordinate conversions
+		for (int n = 0; n < 1000; n++) {
+			Coords coords = lattice2.generateRandomCoords();
+			EXPECT_TRUE(coords.x >= 0 && coords.x < 16);
+			EXPECT_TRUE(coords.y >= 0 && coords.y < 32);
+			EXPECT_TRUE(coords.z >= 0 && coords.z < 8);
+			int64_t site_index = (int64_t)coords.x * 32 * 8 + coords.y * 8 + coords.z;
+			EXPECT_EQ(site_index, lattice2.getSiteIndex(coords));
+			EXPECT_EQ(site_index, lattice2.getSiteIndexUnchecked(coords));
+			EXPECT_EQ(coords, lattice2.getSiteCoords(site_index));
+		}
+		// Check periodic wrapping
+		Coords coords_f;
+		lattice2.calculateDestinationCoords(Coords(15, 0, 7), 1, -2, 0, coords_f);
+		EXPECT_EQ(Coords(0, 30, 7), coords_f);
+		lattice2.calculateDestinationCoords(Coords(0, 31, 3), -3, 2, -1, coords_f);
+		EXPECT_EQ(Coords(13, 1, 2), coords_f);
+		EXPECT_EQ(lattice2.calculateDX(Coords(15, 0, 7), Coords(0, 30, 7)), -16);
+		EXPECT_EQ(lattice2.calculateDY(Coords(15, 0, 7), Coords(0, 30, 7)), 32);
+		// Check that the dimensions must all be powers of two
+		params_lattice.Height = 12;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_FALSE(lattice2.isPowerOfTwo());
+	}
+
+	TEST_F(LatticeTest, BatchDistanceTests) {
+		// Use a number of coordinates that is not a multiple of the vector width to check the remainder loop
+		int num_coords = 1003;
+		for (int periodicity = 0; periodicity < 8; periodicity++) {
+			params_lattice.Length = 7;
+			params_lattice.Width = 8;
+			params_lattice.Height = 9;
+			params_lattice.Enable_periodic_x = (periodicity & 1) != 0;
+			params_lattice.Enable_periodic_y = (periodicity & 2) != 0;
+			params_lattice.Enable_periodic_z = (periodicity & 4) != 0;
+			Lattice lattice2;
+			lattice2.init(params_lattice, &gen);
+			vector<int> x(num_coords), y(num_coords), z(num_coords), distances_sq(num_coords);
+			for (int n = 0; n < num_coords; n++) {
+				Coords coords = lattice2.generateRandomCoords();
+				x[n] = coords.x;
+				y[n] = coords.y;
+				z[n] = coords.z;
+			}
+			for (int m = 0; m < 10; m++) {
+				Coords coords_i = lattice2.generateRandomCoords();
+				lattice2.calculateLatticeDistanceSquared(coords_i, x.data(), y.data(), z.data(), num_coords, distances_sq.data());
+				for (int n = 0; n < num_coords; n++) {
+					EXPECT_EQ(lattice2.calculateLatticeDistanceSquared(coords_i, Coords(x[n], y[n], z[n])), distances_sq[n]);
+				}
+			}
+		}
+		// Check an empty batch
+		lattice.calculateLatticeDistanceSquared(Coords(0, 0, 0), nullptr, nullptr, nullptr, 0, nullptr);
+	}
+
+	TEST_F(LatticeTest, FreeSiteIndexTests) {
+		EXPECT_FALSE(lattice.isFreeSiteIndexEnabled());
+		// Initialize a small lattice with the free site index enabled
+		params_lattice.Length = 5;
+		params_lattice.Width = 6;
+		params_lattice.Height = 7;
+		params_lattice.Enable_free_site_index = true;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isFreeSiteIndexEnabled());
+		// The index is sized during initialization with every site unoccupied
+		EXPECT_EQ(210, lattice2.getNumUnoccupiedSites());
+		EXPECT_FALSE(lattice2.chooseRandomUnoccupiedSite() == Coords(-1, -1, -1));
+		vector<Site> sites2(lattice2.getNumSites());
+		vector<Site*> site_ptrs(sites2.size());
+		for (int i = 0; i < (int)sites2.size(); i++) {
+			site_ptrs[i] = &sites2[i];
+		}
+		// Pre-occupied sites are excluded when the index is built
+		sites2[0].setOccupied();
+		lattice2.setSitePointers(site_ptrs);
+		EXPECT_EQ(209, lattice2.getNumUnoccupiedSites());
+		// Fill the lattice one random unoccupied site at a time
+		for (int n = 0; n < 209; n++) {
+			Coords coords = lattice2.chooseRandomUnoccupiedSite();
+			EXPECT_FALSE(lattice2.isOccupied(coords));
+			lattice2.setOccupied(coords);
+			// Setting an occupied site again must not change the index
+			lattice2.setOccupied(coords);
+			EXPECT_EQ(208 - n, lattice2.getNumUnoccupiedSites());
+		}
+		EXPECT_EQ(Coords(-1, -1, -1), lattice2.chooseRandomUnoccupiedSite());
+		// Clear a few sites and check that only those are chosen
+		lattice2.clearOccupancy(Coords(1, 2, 3));
+		lattice2.clearOccupancy(Coords(4, 5, 6));
+		lattice2.clearOccupancy(Coords(4, 5, 6));
+		EXPECT_EQ(2, lattice2.getNumUnoccupiedSites());
+		for (int n = 0; n < 20; n++) {
+			Coords coords = lattice2.chooseRandomUnoccupiedSite();
+			EXPECT_TRUE(coords == Coords(1, 2, 3) || coords == Coords(4, 5, 6));
+		}
+		// Check the bulk selection of distinct sites with and without the index
+		for (int n = 0; n < (int)sites2.size(); n++) {
+			lattice2.clearOccupancy(n);
+		}
+		lattice.setOccupied(Coords(5, 5, 5));
+		for (auto lattice_ptr : { &lattice2, &lattice }) {
+			int64_t num_unoccupied = lattice_ptr->getNumUnoccupiedSites();
+			vector<Coords> coords_vec = lattice_ptr->chooseRandomUnoccupiedSites(50);
+			EXPECT_EQ(50, (int)coords_vec.size());
+			vector<int64_t> indices;
+			for (auto const &item : coords_vec) {
+				EXPECT_FALSE(lattice_ptr->isOccupied(item));
+				indices.push_back(lattice_ptr->getSiteIndex(item));
+			}
+			sort(indices.begin(), indices.end());
+			EXPECT_TRUE(unique(indices.begin(), indices.end()) == indices.end());
+			EXPECT_EQ(num_unoccupied, lattice_ptr->getNumUnoccupiedSites());
+			EXPECT_THROW(lattice_ptr->chooseRandomUnoccupiedSites((int)num_unoccupied + 1), invalid_argument);
+		}
+		// Without the index, the fallback scan finds the last unoccupied site in a nearly full lattice
+		params_lattice.Enable_free_site_index = false;
+		lattice2.init(params_lattice, &gen);
+		lattice2.setSitePointers(site_ptrs);
+		for (int n = 0; n < (int)sites2.size(); n++) {
+			lattice2.setOccupied(n);
+		}
+		lattice2.clearOccupancy(Coords(2, 3, 4));
+		EXPECT_EQ(1, lattice2.getNumUnoccupiedSites());
+		EXPECT_EQ(Coords(2, 3, 4), lattice2.chooseRandomUnoccupiedSite());
+		lattice2.setOccupied(Coords(2, 3, 4));
+		EXPECT_EQ(Coords(-1, -1, -1), lattice2.chooseRandomUnoccupiedSite());
+		EXPECT_EQ(0, (int)lattice2.chooseRandomUnoccupiedSites(0).size());
+	}
+
+	TEST_F(LatticeTest, HopDisplacementTests) {
+		EXPECT_THROW(lattice.setupHopDisplacements(0.5, 1.0), invalid_argument);
+		EXPECT_THROW(lattice.setupHopDisplacements(2.0, -1.0), invalid_argument);
+		// The first three shells contain 6, 12, and 8 displacements
+		lattice.setupHopDisplacements(1.8, 0.5);
+		auto displacements = lattice.getHopDisplacements();
+		EXPECT_EQ(26, (int)displacements.size());
+		EXPECT_EQ(1, displacements[0].distance_sq);
+		EXPECT_EQ(2, displacements[6].distance_sq);
+		EXPECT_EQ(3, displacements[25].distance_sq);
+		for (auto const &item : displacements) {
+			EXPECT_EQ(item.i*item.i + item.j*item.j + item.k*item.k, item.distance_sq);
+			EXPECT_DOUBLE_EQ(exp(-2.0*0.5*sqrt((double)item.distance_sq)), item.prefactor);
+		}
+		// Check that the destinations match the runtime move functions for non-periodic z-direction boundaries
+		params_lattice.Enable_periodic_z = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		lattice2.setupHopDisplacements(4.0, 0.5);
+		for (auto coords : { Coords(0, 0, 0), Coords(49, 25, 49), Coords(10, 20, 2) }) {
+			vector<int64_t> indices1, indices2;
+			for (auto const &item : lattice2.getHopDisplacements()) {
+				if (lattice2.checkMoveValidity(coords, item.i, item.j, item.k)) {
+					Coords coords_dest;
+					lattice2.calculateDestinationCoords(coords, item.i, item.j, item.k, coords_dest);
+					indices1.push_back(lattice2.getSiteIndex(coords_dest));
+				}
+			}
+			int distance_sq_prev = 0;
+			lattice2.forEachHopDestination(coords, [&](const HopDisplacement& displacement, int64_t site_index) {
+				EXPECT_LE(distance_sq_prev, displacement.distance_sq);
+				distance_sq_prev = displacement.distance_sq;
+				indices2.push_back(site_index);
+			});
+			EXPECT_EQ(indices1, indices2);
+		}
+		int count = 0;
+		lattice2.forEachHopDestination(Coords(5, 5, 0), [&count](const HopDisplacement& displacement, int64_t) {
+			EXPECT_GE(displacement.k, 0);
+			count++;
+		});
+		EXPECT_EQ(152, count);
+		// Displacements in thin periodic directions are limited so that every destination is unique
+		params_lattice.Enable_periodic_z = true;
+		params_lattice.Height = 1;
+		lattice2.init(params_lattice, &gen);
+		lattice2.setupHopDisplacements(1.8, 0.5);
+		EXPECT_EQ(8, (int)lattice2.getHopDisplacements().size());
+		// The neighbor across a periodic direction of size two is included once
+		params_lattice.Height = 50;
+		params_lattice.Width = 2;
+		lattice2.init(params_lattice, &gen);
+		lattice2.setupHopDisplacements(1.0, 0.5);
+		EXPECT_EQ(5, (int)lattice2.getHopDisplacements().size());
+		// The image at half of an even periodic lattice size is included once in each direction
+		params_lattice.Length = 4;
+		params_lattice.Width = 4;
+		params_lattice.Height = 4;
+		lattice2.init(params_lattice, &gen);
+		lattice2.setupHopDisplacements(2.0, 0.5);
+		EXPECT_EQ(29, (int)lattice2.getHopDisplacements().size());
+		vector<int64_t> destinations;
+		lattice2.forEachHopDestination(Coords(1, 2, 3), [&destinations](const HopDisplacement&, int64_t site_index) {
+			destinations.push_back(site_index);
+		});
+		sort(destinations.begin(), destinations.end());
+		EXPECT_TRUE(adjacent_find(destinations.begin(), destinations.end()) == destinations.end());
+		EXPECT_EQ(29, (int)destinations.size());
+		// A cutoff radius that is exactly at a shell distance includes the shell despite rounding errors
+		lattice.setupHopDisplacements(sqrt(3.0), 0.5);
+		EXPECT_EQ(26, (int)lattice.getHopDisplacements().size());
+	}
+
+	TEST_F(LatticeTest, SparseStorageTests) {
+		EXPECT_FALSE(lattice.isSparse());
+		// The sparse storage mode cannot be combined with the free site index
+		params_lattice.Enable_sparse_storage = true;
+		params_lattice.Enable_free_site_index = true;
+		EXPECT_FALSE(params_lattice.checkParameters());
+		params_lattice.Enable_free_site_index = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isSparse());
+		EXPECT_EQ(lattice.getNumSites(), lattice2.getNumSites());
+		// Check that the occupancy matches a dense lattice for a random sequence of operations
+		for (int n = 0; n < 20000; n++) {
+			int64_t site_index = lattice.getSiteIndex(lattice.generateRandomCoords()) % 2000;
+			if (n % 3 == 0) {
+				lattice.clearOccupancy(site_index);
+				lattice2.clearOccupancy(site_index);
+			}
+			else {
+				lattice.setOccupied(site_index);
+				lattice2.setOccupied(site_index);
+			}
+		}
+		for (int64_t n = 0; n < lattice.getNumSites(); n++) {
+			EXPECT_EQ(lattice.isOccupied(n), lattice2.isOccupied(n));
+		}
+		EXPECT_EQ(lattice.getNumUnoccupiedSites(), lattice2.getNumUnoccupiedSites());
+		stringstream ss1, ss2;
+		auto old_buffer = cout.rdbuf(ss1.rdbuf());
+		lattice.outputLatticeOccupancy();
+		cout.rdbuf(ss2.rdbuf());
+		lattice2.outputLatticeOccupancy();
+		cout.rdbuf(old_buffer);
+		EXPECT_EQ(ss1.str(), ss2.str());
+		// Check the object pointer assignment
+		Object object;
+		Coords coords(5, 6, 7);
+		int64_t site_index = lattice2.getSiteIndex(coords);
+		lattice2.clearOccupancy(site_index);
+		EXPECT_EQ(nullptr, lattice2.getObjectPtr(site_index));
+		lattice2.setObjectPtr(site_index, &object);
+		EXPECT_TRUE(lattice2.isOccupied(coords));
+		EXPECT_EQ(&object, lattice2.getObjectPtr(site_index));
+		// Site objects are created on request using the site factory and keep their state when the site is cleared
+		int num_created = 0;
+		lattice2.setSiteFactory([&num_created]() {
+			num_created++;
+			return new Site();
+		});
+		Site* site_ptr = lattice2.getSitePtr(site_index);
+		EXPECT_EQ(1, num_created);
+		EXPECT_TRUE(site_ptr->isOccupied());
+		EXPECT_EQ(&object, site_ptr->getObjectPtr());
+		lattice2.clearOccupancy(site_index);
+		EXPECT_FALSE(site_ptr->isOccupied());
+		EXPECT_EQ(site_ptr, lattice2.getSitePtr(site_index));
+		EXPECT_EQ(1, num_created);
+		lattice2.setOccupied(site_index);
+		EXPECT_TRUE(site_ptr->isOccupied());
+		// The site vector cannot be used in sparse storage mode
+		EXPECT_THROW(lattice2.getSiteIt(coords), logic_error);
+		EXPECT_THROW(lattice2.getSiteIt(site_index), logic_error);
+		vector<Site*> site_ptrs(lattice2.getNumSites(), nullptr);
+		EXPECT_FALSE(lattice2.setSitePointers(site_ptrs));
+		// Check the random unoccupied site selection
+		vector<Coords> coords_vec = lattice2.chooseRandomUnoccupiedSites(100);
+		for (auto const &item : coords_vec) {
+			EXPECT_FALSE(lattice2.isOccupied(item));
+		}
+		EXPECT_FALSE(lattice2.isOccupied(lattice2.chooseRandomUnoccupiedSite()));
+	}
+
+	TEST_F(LatticeTest, LargeLatticeTests) {
+		// Lattices with more than INT_MAX sites use 64-bit site indices in sparse storage mode
+		params_lattice.Length = 1300;
+		params_lattice.Width = 1300;
+		params_lattice.Height = 1300;
+		params_lattice.Enable_sparse_storage = true;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_EQ((int64_t)1300 * 1300 * 1300, lattice2.getNumSites());
+		EXPECT_GT(lattice2.getNumSites(), (int64_t)numeric_limits<int>::max());
+		EXPECT_DOUBLE_EQ(1300.0 * 1300.0 * 1300.0 * 1e-21, lattice2.getVolume());
+		Coords coords(1299, 1299, 1299);
+		int64_t site_index = lattice2.getSiteIndex(coords);
+		EXPECT_EQ(lattice2.getNumSites() - 1, site_index);
+		EXPECT_EQ(site_index, lattice2.getSiteIndexUnchecked(coords));
+		EXPECT_EQ(coords, lattice2.getSiteCoords(site_index));
+		EXPECT_THROW(lattice2.getSiteCoords(lattice2.getNumSites()), out_of_range);
+		for (int n = 0; n < 1000; n++) {
+			coords = lattice2.generateRandomCoords();
+			site_index = lattice2.getSiteIndex(coords);
+			EXPECT_EQ(coords, lattice2.getSiteCoords(site_index));
+			lattice2.setOccupied(site_index);
+			EXPECT_TRUE(lattice2.isOccupied(coords));
+		}
+		coords = lattice2.chooseRandomUnoccupiedSite();
+		EXPECT_FALSE(lattice2.isOccupied(coords));
+		// Check that bulk selection of many sites returns distinct unoccupied sites
+		vector<Coords> coords_vec = lattice2.chooseRandomUnoccupiedSites(200000);
+		ASSERT_EQ(200000, (int)coords_vec.size());
+		set<int64_t> chosen_indices;
+		for (auto const &item : coords_vec) {
+			EXPECT_FALSE(lattice2.isOccupied(item));
+			chosen_indices.insert(lattice2.getSiteIndex(item));
+		}
+		EXPECT_EQ(coords_vec.size(), chosen_indices.size());
+		// Check a power of two lattice with exactly 2^31 sites
+		params_lattice.Length = 2048;
+		params_lattice.Width = 1024;
+		params_lattice.Height = 1024;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isPowerOfTwo());
+		EXPECT_EQ((int64_t)1 << 31, lattice2.getNumSites());
+		coords.setXYZ(2047, 1023, 1023);
+		site_index = lattice2.getSiteIndex(coords);
+		EXPECT_EQ(lattice2.getNumSites() - 1, site_index);
+		EXPECT_EQ(coords, lattice2.getSiteCoords(site_index));
+		lattice2.setOccupied(site_index);
+		EXPECT_TRUE(lattice2.isOccupied(site_index));
+		EXPECT_FALSE(lattice2.isOccupied(site_index - ((int64_t)1 << 31) + 1));
+		// Check a lattice where the area of each x-plane has more than INT_MAX sites
+		params_lattice.Length = 3;
+		params_lattice.Width = 50000;
+		params_lattice.Height = 50000;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_FALSE(lattice2.isPowerOfTwo());
+		EXPECT_GT((int64_t)params_lattice.Width * params_lattice.Height, (int64_t)numeric_limits<int>::max());
+		for (auto const &item : { Coords(2, 49999, 49999), Coords(1, 49999, 12345), Coords(0, 42950, 0) }) {
+			site_index = lattice2.getSiteIndex(item);
+			EXPECT_EQ(item, lattice2.getSiteCoords(site_index));
+			EXPECT_EQ(item, lattice2.getSiteCoordsUnchecked(site_index));
+		}
+	}
+
+	TEST_F(LatticeTest, NeighborCountsTests) {
+		EXPECT_FALSE(lattice.isNeighborCountsEnabled());
+		params_lattice.Enable_neighbor_counts = true;
+		params_lattice.Enable_sparse_storage = true;
+		EXPECT_FALSE(params_lattice.checkParameters());
+		params_lattice.Enable_sparse_storage = false;
+		vector<Coords> displacements = { Coords(1, 0, 0), Coords(-1, 0, 0), Coords(0, 1, 0), Coords(0, -1, 0), Coords(0, 0, 1), Coords(0, 0, -1) };
+		// Check small lattices with mixed boundaries, including thin periodic directions where a neighbor in both directions is the same site
+		for (int width : { 7, 1, 2 }) {
+			params_lattice.Length = 6;
+			params_lattice.Width = width;
+			params_lattice.Height = 5;
+			params_lattice.Enable_periodic_z = false;
+			Lattice lattice2, lattice3;
+			lattice2.init(params_lattice, &gen);
+			EXPECT_TRUE(lattice2.isNeighborCountsEnabled());
+			params_lattice.Enable_neighbor_counts = false;
+			lattice3.init(params_lattice, &gen);
+			params_lattice.Enable_neighbor_counts = true;
+			vector<Site> sites2(lattice2.getNumSites()), sites3(lattice3.getNumSites());
+			vector<Site*> site_ptrs2, site_ptrs3;
+			for (int n = 0; n < (int)sites2.size(); n++) {
+				site_ptrs2.push_back(&sites2[n]);
+				site_ptrs3.push_back(&sites3[n]);
+			}
+			// Pre-occupied sites are counted when the site pointers are set
+			sites2[3].setOccupied();
+			sites3[3].setOccupied();
+			lattice2.setSitePointers(site_ptrs2);
+			lattice3.setSitePointers(site_ptrs3);
+			Object object;
+			for (int n = 0; n < 5000; n++) {
+				Coords coords = lattice2.generateRandomCoords();
+				int64_t site_index = lattice2.getSiteIndex(coords);
+				if (n % 3 == 0) {
+					lattice2.clearOccupancy(site_index);
+					lattice3.clearOccupancy(site_index);
+				}
+				else if (n % 3 == 1) {
+					lattice2.setOccupied(coords);
+					lattice3.setOccupied(coords);
+				}
+				else {
+					lattice2.setObjectPtr(site_index, &object);
+					lattice3.setObjectPtr(site_index, &object);
+				}
+				// Compare the maintained counts to the counts calculated by checking each neighbor
+				coords = lattice2.generateRandomCoords();
+				vector<Coords> neighbors;
+				for (auto const &item : displacements) {
+					if (lattice2.checkMoveValidity(coords, item.x, item.y, item.z)) {
+						Coords coords_dest;
+						lattice2.calculateDestinationCoords(coords, item.x, item.y, item.z, coords_dest);
+						if (!(coords_dest == coords) && lattice2.isOccupied(coords_dest) && find(neighbors.begin(), neighbors.end(), coords_dest) == neighbors.end()) {
+							neighbors.push_back(coords_dest);
+						}
+					}
+				}
+				int count = (int)neighbors.size();
+				EXPECT_EQ(count, lattice2.getNumOccupiedNeighbors(coords));
+				EXPECT_EQ(count, lattice3.getNumOccupiedNeighbors(coords));
+			}
+		}
+	}
+
+	TEST_F(LatticeTest, SiteStatesTests) {
+		EXPECT_FALSE(lattice.isSiteStatesEnabled());
+		EXPECT_FALSE(lattice.setSiteTypes(vector<uint8_t>(lattice.getNumSites(), 1)));
+		params_lattice.Enable_site_states = true;
+		params_lattice.Enable_sparse_storage = true;
+		EXPECT_FALSE(params_lattice.checkParameters());
+		params_lattice.Enable_sparse_storage = false;
+		params_lattice.Length = 6;
+		params_lattice.Width = 7;
+		params_lattice.Height = 5;
+		params_lattice.Enable_periodic_z = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isSiteStatesEnabled());
+		vector<Site> sites2(lattice2.getNumSites());
+		vector<Site*> site_ptrs;
+		for (auto& item : sites2) {
+			site_ptrs.push_back(&item);
+		}
+		lattice2.setSitePointers(site_ptrs);
+		// Check the bulk site type functions
+		EXPECT_FALSE(lattice2.setSiteTypes(vector<uint8_t>(10, 1)));
+		vector<uint8_t> types(lattice2.getNumSites());
+		for (int64_t n = 0; n < lattice2.getNumSites(); n++) {
+			types[n] = (lattice2.getSiteCoords(n).x < 3) ? 1 : 2;
+		}
+		EXPECT_TRUE(lattice2.setSiteTypes(types));
+		vector<int64_t> interface_indices;
+		for (int y = 0; y < 7; y++) {
+			for (int z = 0; z < 5; z++) {
+				interface_indices.push_back(lattice2.getSiteIndex(Coords(2, y, z)));
+			}
+		}
+		EXPECT_FALSE(lattice2.setSiteTypes({ 0, -1 }, 3));
+		EXPECT_TRUE(lattice2.setSiteTypes(interface_indices, 3));
+		EXPECT_EQ(1, lattice2.getSiteType(lattice2.getSiteIndex(Coords(1, 4, 4))));
+		EXPECT_EQ(3, lattice2.getSiteType(lattice2.getSiteIndex(Coords(2, 4, 4))));
+		lattice2.setSiteType(lattice2.getSiteIndex(Coords(3, 4, 4)), 4);
+		EXPECT_EQ(4, lattice2.getSiteType(lattice2.getSiteIndex(Coords(3, 4, 4))));
+		// Check the neighbor type queries, including the periodic x-direction and non-periodic z-direction boundaries
+		EXPECT_EQ(1, lattice2.getNumNeighborsOfType(lattice2.getSiteIndex(Coords(1, 2, 2)), 3));
+		EXPECT_EQ(4, lattice2.getNumNeighborsOfType(lattice2.getSiteIndex(Coords(2, 2, 2)), 3));
+		EXPECT_EQ(3, lattice2.getNumNeighborsOfType(lattice2.getSiteIndex(Coords(2, 2, 0)), 3));
+		EXPECT_EQ(1, lattice2.getNumNeighborsOfType(lattice2.getSiteIndex(Coords(5, 2, 2)), 1));
+		EXPECT_EQ(1, lattice2.getNumNeighborsOfType(lattice2.getSiteIndex(Coords(3, 4, 3)), 4));
+		// Check the species codes and neighbor species queries
+		int64_t site_index = lattice2.getSiteIndex(Coords(2, 2, 2));
+		lattice2.setOccupied(site_index);
+		lattice2.setSiteSpecies(site_index, 5);
+		EXPECT_EQ(5, lattice2.getSiteSpecies(site_index));
+		EXPECT_EQ(1, lattice2.getNumNeighborsOfSpecies(lattice2.getSiteIndex(Coords(2, 3, 2)), 5));
+		EXPECT_EQ(0, lattice2.getNumNeighborsOfSpecies(lattice2.getSiteIndex(Coords(2, 4, 2)), 5));
+		EXPECT_EQ(5, lattice2.getNumNeighborsOfSpecies(lattice2.getSiteIndex(Coords(2, 3, 2)), 0));
+		lattice2.clearOccupancy(site_index);
+		EXPECT_EQ(0, lattice2.getSiteSpecies(site_index));
+		// Check that the neighbor across a periodic direction of size two is only counted once
+		params_lattice.Length = 2;
+		Lattice lattice3;
+		lattice3.init(params_lattice, &gen);
+		vector<Site> sites3(lattice3.getNumSites());
+		site_ptrs.clear();
+		for (auto& item : sites3) {
+			site_ptrs.push_back(&item);
+		}
+		lattice3.setSitePointers(site_ptrs);
+		int64_t site_index2 = lattice3.getSiteIndex(Coords(1, 2, 2));
+		lattice3.setSiteType(site_index2, 2);
+		lattice3.setOccupied(site_index2);
+		lattice3.setSiteSpecies(site_index2, 5);
+		EXPECT_EQ(1, lattice3.getNumNeighborsOfType(lattice3.getSiteIndex(Coords(0, 2, 2)), 2));
+		EXPECT_EQ(1, lattice3.getNumNeighborsOfSpecies(lattice3.getSiteIndex(Coords(0, 2, 2)), 5));
+		EXPECT_EQ(4, lattice3.getNumNeighborsOfSpecies(lattice3.getSiteIndex(Coords(0, 2, 2)), 0));
+	}
+
+	TEST_F(LatticeTest, SiteEnergiesTests) {
+		EXPECT_FALSE(lattice.isSiteEnergiesEnabled());
+		EXPECT_THROW(lattice.createGaussianSiteEnergies(0.0, 0.05), logic_error);
+		EXPECT_FALSE(lattice.setSiteEnergies(vector<float>(lattice.getNumSites(), 0.0f)));
+		params_lattice.Enable_site_energies = true;
+		params_lattice.Enable_sparse_storage = true;
+		EXPECT_FALSE(params_lattice.checkParameters());
+		params_lattice.Enable_sparse_storage = false;
+		params_lattice.Enable_periodic_z = false;
+		Lattice lattice2;
+		lattice2.init(params_lattice, &gen);
+		EXPECT_TRUE(lattice2.isSiteEnergiesEnabled());
+		// Check the density of states generators
+		lattice2.createGaussianSiteEnergies(0.1, 0.05);
+		auto energies = lattice2.getSiteEnergies();
+		EXPECT_EQ(lattice2.getNumSites(), (int64_t)energies.size());
+		EXPECT_NEAR(0.1, vector_avg(energies), 1e-3);
+		EXPECT_NEAR(0.05, vector_stdev(energies), 1e-3);
+		lattice2.createExponentialSiteEnergies(0.0, 0.03);
+		EXPECT_FALSE(lattice2.getSiteEnergies() == energies);
+		EXPECT_FALSE(lattice2.setSiteEnergies(vector<float>(10, 0.0f)));
+		EXPECT_TRUE(lattice2.setSiteEnergies(energies));
+		EXPECT_FLOAT_EQ(energies[123], lattice2.getSiteEnergy(123));
+		lattice2.setSiteEnergy(123, 1.5f);
+		EXPECT_FLOAT_EQ(1.5f, lattice2.getSiteEnergy(123));
+		// Check the batched energy differences against the individual hop destinations
+		lattice2.setupHopDisplacements(3.0, 1.0);
+		int num_displacements = (int)lattice2.getHopDisplacements().size();
+		vector<int64_t> dest_indices(num_displacements);
+		vector<float> energy_diffs(num_displacements);
+		for (auto coords : { Coords(0, 0, 0), Coords(25, 49, 49), Coords(10, 20, 30) }) {
+			lattice2.calculateHopEnergyDifferences(coords, dest_indices.data(), energy_diffs.data());
+			float energy_start = lattice2.getSiteEnergy(lattice2.getSiteIndex(coords));
+			int num_valid = 0;
+			for (int n = 0; n < num_displacements; n++) {
+				auto displacement = lattice2.getHopDisplacements()[n];
+				if (lattice2.checkMoveValidity(coords, displacement.i, displacement.j, displacement.k)) {
+					Coords coords_dest;
+					lattice2.calculateDestinationCoords(coords, displacement.i, displacement.j, displacement.k, coords_dest);
+					EXPECT_EQ(lattice2.getSiteIndex(coords_dest), dest_indices[n]);
+					EXPECT_FLOAT_EQ(lattice2.getSiteEnergy(dest_indices[n]) - energy_start, energy_diffs[n]);
+					num_valid++;
+				}
+				else {
+					EXPECT_EQ(-1, dest_indices[n]);
+					EXPECT_TRUE(isinf(energy_diffs[n]) && energy_diffs[n] > 0);
+				}
+			}
+			int count = 0;
+			lattice2.forEachHopDestination(coords, [&count](const HopDisplacement&, int64_t) { count++; });
+			EXPECT_EQ(count, num_valid);
+		}
+	}
+
+	TEST_F(LatticeTest, ParallelInitializationTests) {
+		params_lattice.Enable_site_energies = true;
+		Lattice lattice2, lattice3;
+		lattice2.init(params_lattice, &gen);
+		lattice3.init(params_lattice, &gen);
+		// Check that the site energies do not depend on the number of threads
+		lattice2.createGaussianSiteEnergies(0.1, 0.05, 2468, 1);
+		lattice3.createGaussianSiteEnergies(0.1, 0.05, 2468, 0);
+		EXPECT_TRUE(lattice2.getSiteEnergies() == lattice3.getSiteEnergies());
+		EXPECT_NEAR(0.1, vector_avg(lattice2.getSiteEnergies()), 1e-3);
+		EXPECT_NEAR(0.05, vector_stdev(lattice2.getSiteEnergies()), 1e-3);
+		lattice2.createExponentialSiteEnergies(0.0, 0.03, 2468, 3);
+		lattice3.createExponentialSiteEnergies(0.0, 0.03, 2468, 6);
+		EXPECT_TRUE(lattice2.getSiteEnergies() == lattice3.getSiteEnergies());
+		// Check the parallel assignment of a contiguous site vector
+		vector<Site> sites(10);
+		EXPECT_FALSE(lattice2.setSites(sites, 4));
+		sites.resize((size_t)lattice2.getNumSites());
+		lattice2.forEachSiteParallel(4, [&sites](int64_t site_index) {
+			if (site_index % 10 == 0) {
+				sites[site_index].setOccupied();
+			}
+		});
+		EXPECT_TRUE(lattice2.setSites(sites, 4));
+		EXPECT_EQ(&sites[12345], lattice2.getSitePtr(12345));
+		EXPECT_TRUE(lattice2.isOccupied(123450));
+		EXPECT_FALSE(lattice2.isOccupied(123451));
+	}
+
+	TEST_F(LatticeTest, DisplacementTableTests) {
+		EXPECT_THROW(lattice.lookupDisplacement(Coords(0, 0, 0), Coords(1, 0, 0)), logic_error);
+		EXPECT_THROW(lattice.setupDisplacementTable(0), invalid_argument);
+		// Check that the table distances match the arithmetic distances for all boundary conditions
+		for (int periodicity = 0; periodicity < 8; periodicity++) {
+			params_lattice.Length = 7;
+			params_lattice.Width = 8;
+			params_lattice.Height = 9;
+			params_lattice.Enable_periodic_x = (periodicity & 1) != 0;
+			params_lattice.Enable_periodic_y = (periodicity & 2) != 0;
+			params_lattice.Enable_periodic_z = (periodicity & 4) != 0;
+			Lattice lattice2, lattice3;
+			lattice2.init(params_lattice, &gen);
+			lattice3.init(params_lattice, &gen);
+			lattice3.setupDisplacementTable(2);
+			for (int n = 0; n < 1000; n++) {
+				Coords coords_i = lattice2.generateRandomCoords();
+				Coords coords_f = lattice2.generateRandomCoords();
+				int distance_sq = lattice2.calculateLatticeDistanceSquared(coords_i, coords_f);
+				EXPECT_EQ(distance_sq, lattice3.calculateLatticeDistanceSquared(coords_i, coords_f));
+				const DisplacementEntry* entry_ptr = lattice3.lookupDisplacement(coords_i, coords_f);
+				if (entry_ptr != nullptr) {
+					EXPECT_EQ(distance_sq, entry_ptr->distance_sq);
+					if (distance_sq > 0) {
+						EXPECT_NEAR(1.0, entry_ptr->unit_x*entry_ptr->unit_x + entry_ptr->unit_y*entry_ptr->unit_y + entry_ptr->unit_z*entry_ptr->unit_z, 1e-6);
+					}
+				}
+				else {
+					EXPECT_GT(distance_sq, 4);
+				}
+			}
+		}
+		// Check the direction of a displacement across a periodic boundary
+		lattice.setupDisplacementTable(3);
+		const DisplacementEntry* entry_ptr = lattice.lookupDisplacement(Coords(49, 0, 0), Coords(1, 48, 0));
+		ASSERT_NE(nullptr, entry_ptr);
+		EXPECT_EQ(8, entry_ptr->distance_sq);
+		EXPECT_FLOAT_EQ((float)(1.0 / sqrt(8.0)), entry_ptr->inverse_distance);
+		EXPECT_FLOAT_EQ((float)(2.0 / sqrt(8.0)), entry_ptr->unit_x);
+		EXPECT_FLOAT_EQ((float)(-2.0 / sqrt(8.0)), entry_ptr->unit_y);
+		EXPECT_FLOAT_EQ(0.0f, entry_ptr->unit_z);
+		entry_ptr = lattice.lookupDisplacement(Coords(5, 5, 5), Coords(5, 5, 5));
+		ASSERT_NE(nullptr, entry_ptr);
+		EXPECT_EQ(0, entry_ptr->distance_sq);
+		EXPECT_FLOAT_EQ(0.0f, entry_ptr->inverse_distance);
+		EXPECT_EQ(nullptr, lattice.lookupDisplacement(Coords(5, 5, 5), Coords(9, 5, 5)));
+	}
+
 	TEST_F(LatticeTest, GetSiteCoordsTests) {
 		Coords coords1, coords2;
 		int index;
@@ -1374,6 +2862,24 @@ namespace LatticeTests {
 		}
 	}
 
+	TEST_F(LatticeTest, UncheckedSiteIndexTests) {
+		Coords coords;
+		for (int i = 0; i < 100; i++) {
+			coords = lattice.generateRandomCoords();
+			EXPECT_EQ(lattice.getSiteIndex(coords), lattice.getSiteIndexUnchecked(coords));
+		}
+		// Check the index-based occupancy functions
+		coords.setXYZ(5, 6, 7);
+		int64_t site_index = lattice.getSiteIndexUnchecked(coords);
+		EXPECT_FALSE(lattice.isOccupied(site_index));
+		lattice.setOccupied(site_index);
+		EXPECT_TRUE(lattice.isOccupied(site_index));
+		EXPECT_TRUE(lattice.isOccupied(coords));
+		EXPECT_EQ(*lattice.getSiteIt(coords), *lattice.getSiteIt(site_index));
+		lattice.clearOccupancy(site_index);
+		EXPECT_FALSE(lattice.isOccupied(coords));
+	}
+
 	TEST_F(LatticeTest, OccupancyTests) {
 		Coords coords;
 		for (int x = 0; x < lattice.getLength(); x++) {
@@ -1433,6 +2939,311 @@ namespace LatticeTests {
 	}
 }
 
+namespace SiteHashMapTests {
+
+	TEST(SiteHashMapTests, InsertEraseTests) {
+		SiteHashMap site_map;
+		EXPECT_EQ(0, site_map.size());
+		EXPECT_EQ(nullptr, site_map.find(5));
+		site_map.erase(5);
+		// Compare against a reference set for a random sequence of insertions and deletions
+		RandomEngine gen(std::random_device{}());
+		uniform_int_distribution<int64_t> dist(0, 999);
+		set<int64_t> reference;
+		for (int n = 0; n < 100000; n++) {
+			int64_t site_index = dist(gen);
+			if (n % 2 == 0) {
+				site_map.insert(site_index).occupied = true;
+				reference.insert(site_index);
+			}
+			else {
+				site_map.erase(site_index);
+				reference.erase(site_index);
+			}
+			EXPECT_EQ((int64_t)reference.size(), site_map.size());
+		}
+		for (int64_t site_index = 0; site_index < 1000; site_index++) {
+			const SiteHashMap& site_map_ref = site_map;
+			const SiteHashMap::Entry* entry_ptr = site_map_ref.find(site_index);
+			if (reference.count(site_index) > 0) {
+				ASSERT_NE(nullptr, entry_ptr);
+				EXPECT_EQ(site_index, entry_ptr->site_index);
+				EXPECT_TRUE(entry_ptr->occupied);
+			}
+			else {
+				EXPECT_EQ(nullptr, entry_ptr);
+			}
+		}
+		// Inserting an existing index returns the existing entry
+		Object object;
+		site_map.insert(2000).object_ptr = &object;
+		int64_t size = site_map.size();
+		EXPECT_EQ(&object, site_map.insert(2000).object_ptr);
+		EXPECT_EQ(size, site_map.size());
+		site_map.clear();
+		EXPECT_EQ(0, site_map.size());
+		EXPECT_EQ(nullptr, site_map.find(2000));
+	}
+}
+
+namespace RandomTests {
+
+	TEST(RandomTests, PhiloxTests) {
+		// Check the known answer tests from the reference implementation
+		uint32_t output[4];
+		const uint32_t counter_zero[4] = { 0, 0, 0, 0 };
+		const uint32_t key_zero[2] = { 0, 0 };
+		Philox4x32::generateBlock(counter_zero, key_zero, output);
+		EXPECT_EQ(0x6627e8d5u, output[0]);
+		EXPECT_EQ(0xe169c58du, output[1]);
+		EXPECT_EQ(0xbc57ac4cu, output[2]);
+		EXPECT_EQ(0x9b00dbd8u, output[3]);
+		const uint32_t counter_ones[4] = { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu };
+		const uint32_t key_ones[2] = { 0xffffffffu, 0xffffffffu };
+		Philox4x32::generateBlock(counter_ones, key_ones, output);
+		EXPECT_EQ(0x408f276du, output[0]);
+		EXPECT_EQ(0x41c83b0eu, output[1]);
+		EXPECT_EQ(0xa20bc7c6u, output[2]);
+		EXPECT_EQ(0x6d5451fdu, output[3]);
+		const uint32_t counter_pi[4] = { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u };
+		const uint32_t key_pi[2] = { 0xa4093822u, 0x299f31d0u };
+		Philox4x32::generateBlock(counter_pi, key_pi, output);
+		EXPECT_EQ(0xd16cfe09u, output[0]);
+		EXPECT_EQ(0x94fdccebu, output[1]);
+		EXPECT_EQ(0x5001e420u, output[2]);
+		EXPECT_EQ(0x24126ea1u, output[3]);
+		// Check that the engine produces the blocks of consecutive counters
+		Philox4x32 gen(0x299f31d0a4093822ULL, 7);
+		for (uint64_t block = 0; block < 3; block++) {
+			Philox4x32::generateBlock(0x299f31d0a4093822ULL, block, 7, output);
+			for (int n = 0; n < 4; n++) {
+				EXPECT_EQ(output[n], gen());
+			}
+		}
+		// Check that the engine works with the standard library distributions
+		gen.seed(42);
+		uniform_real_distribution<double> dist(0.0, 1.0);
+		double sum = 0.0;
+		for (int n = 0; n < 1000000; n++) {
+			sum += dist(gen);
+		}
+		EXPECT_NEAR(0.5, sum / 1000000, 2e-3);
+		// Check the conversion to the unit interval
+		EXPECT_DOUBLE_EQ(1.0, Philox4x32::convertToDouble(0xffffffffu, 0xffffffffu));
+		EXPECT_GT(Philox4x32::convertToDouble(0, 0), 0.0);
+	}
+
+	TEST(RandomTests, Pcg64Tests) {
+		// Check the known answer test from the reference implementation with seed 42 and stream 54
+		Pcg64 gen(42, 54);
+		EXPECT_EQ(0x86b1da1d72062b68ULL, gen());
+		EXPECT_EQ(0x1304aa46c9853d39ULL, gen());
+		EXPECT_EQ(0xa3670e9e0dd50358ULL, gen());
+		EXPECT_EQ(0xf9090e529a7dae00ULL, gen());
+		// Check that reseeding restarts the sequence and that the default stream differs
+		gen.seed(42, 54);
+		EXPECT_EQ(0x86b1da1d72062b68ULL, gen());
+		gen.seed(42);
+		EXPECT_EQ(0x287472e87ff5705aULL, gen());
+		EXPECT_EQ(0xbbd190b04ed0b545ULL, gen());
+		// Check that the engine works with the standard library distributions
+		gen.seed(1);
+		uniform_real_distribution<double> dist(0.0, 1.0);
+		double sum = 0.0;
+		for (int n = 0; n < 1000000; n++) {
+			sum += dist(gen);
+		}
+		EXPECT_NEAR(0.5, sum / 1000000, 2e-3);
+	}
+
+	TEST(RandomTests, Uniform01Tests) {
+		// Check that the conversion of 32-bit engines matches the Philox4x32 conversion function
+		Philox4x32 gen1(7, 3);
+		Philox4x32 gen2(7, 3);
+		vector<double> data(301);
+		generateUniform01(gen1, data.data(), data.size());
+		for (auto const &item : data) {
+			uint32_t high = gen2();
+			uint32_t low = gen2();
+			EXPECT_DOUBLE_EQ(Philox4x32::convertToDouble(high, low), item);
+		}
+		// Check the conversion of 64-bit engines, including partial blocks
+		Xoshiro256pp gen3(5);
+		Xoshiro256pp gen4(5);
+		generateUniform01(gen3, data.data(), data.size());
+		for (auto const &item : data) {
+			EXPECT_DOUBLE_EQ((double)((gen4() >> 11) + 1) / 9007199254740992.0, item);
+		}
+		// Check the range and mean of a large block
+		data.resize(1000000);
+		generateUniform01(gen3, data.data(), data.size());
+		EXPECT_GT(*min_element(data.begin(), data.end()), 0.0);
+		EXPECT_LE(*max_element(data.begin(), data.end()), 1.0);
+		EXPECT_NEAR(0.5, vector_avg(data), 2e-3);
+	}
+
+	TEST(RandomTests, BoundedSamplerTests) {
+		// Check the high part of 128-bit products
+		EXPECT_EQ(0xFFFFFFFFFFFFFFFEULL, calculateMultiplyHigh(0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL));
+		EXPECT_EQ(1ULL, calculateMultiplyHigh(1ULL << 32, 1ULL << 32));
+		EXPECT_EQ(0ULL, calculateMultiplyHigh(12345ULL, 67890ULL));
+		// Check that the samplers with a range of one always generate zero
+		Xoshiro256pp gen(11);
+		BoundedSampler32 sampler32;
+		BoundedSampler64 sampler64;
+		EXPECT_EQ(1u, sampler32.getRange());
+		EXPECT_EQ(1ULL, sampler64.getRange());
+		for (int n = 0; n < 100; n++) {
+			EXPECT_EQ(0u, sampler32.generate(gen));
+			EXPECT_EQ(0ULL, sampler64.generate(gen));
+		}
+		// Check that the cached and uncached versions generate the same sequence
+		sampler32.setRange(7);
+		sampler64.setRange(7);
+		Xoshiro256pp gen1(3);
+		Xoshiro256pp gen2(3);
+		for (int n = 0; n < 1000; n++) {
+			EXPECT_EQ(BoundedSampler32::generate(gen1, 7), sampler32.generate(gen2));
+			EXPECT_EQ(BoundedSampler64::generate(gen1, 7), sampler64.generate(gen2));
+		}
+		// Check the uniformity with a chi-squared test for several ranges with 32-bit and 64-bit engines
+		Philox4x32 gen_philox(5);
+		for (uint32_t range : { 2u, 6u, 7u, 100u }) {
+			vector<int> counts32(range, 0);
+			vector<int> counts64(range, 0);
+			sampler32.setRange(range);
+			sampler64.setRange(range);
+			const int N_samples = 100000 * (int)range;
+			for (int n = 0; n < N_samples; n++) {
+				counts32[sampler32.generate(gen)]++;
+				counts64[sampler64.generate(gen_philox)]++;
+			}
+			double chi_sq32 = 0.0;
+			double chi_sq64 = 0.0;
+			double expected = (double)N_samples / range;
+			for (uint32_t i = 0; i < range; i++) {
+				chi_sq32 += intpow(counts32[i] - expected, 2) / expected;
+				chi_sq64 += intpow(counts64[i] - expected, 2) / expected;
+			}
+			// Upper bound of the chi-squared distribution for a significance level of about 0.001
+			double critical_value = (range - 1) + 4.5*sqrt(2.0*(range - 1)) + 10.0;
+			EXPECT_LT(chi_sq32, critical_value);
+			EXPECT_LT(chi_sq64, critical_value);
+		}
+		// Check ranges that are large enough for the rejection step to be frequent
+		const uint32_t range_large32 = 3000000000u;
+		const uint64_t range_large64 = 12000000000000000000ULL;
+		sampler32.setRange(range_large32);
+		sampler64.setRange(range_large64);
+		double sum32 = 0.0;
+		double sum64 = 0.0;
+		for (int n = 0; n < 1000000; n++) {
+			uint32_t value32 = sampler32.generate(gen);
+			uint64_t value64 = sampler64.generate(gen);
+			EXPECT_LT(value32, range_large32);
+			EXPECT_LT(value64, range_large64);
+			sum32 += value32;
+			sum64 += (double)value64;
+		}
+		EXPECT_NEAR(0.5, sum32 / 1000000 / range_large32, 2e-3);
+		EXPECT_NEAR(0.5, sum64 / 1000000 / (double)range_large64, 2e-3);
+	}
+
+	// Calculates the Kolmogorov-Smirnov statistic of the input sample relative to the exponential distribution with a mean of one
+	double calculateExponentialKS(vector<double> data) {
+		sort(data.begin(), data.end());
+		double statistic = 0.0;
+		for (int i = 0; i < (int)data.size(); i++) {
+			double cdf = 1.0 - exp(-data[i]);
+			statistic = max(statistic, max(fabs((double)(i + 1) / data.size() - cdf), fabs((double)i / data.size() - cdf)));
+		}
+		return statistic;
+	}
+
+	TEST(RandomTests, ZigguratExponentialTests) {
+		// Check that the layers have equal areas and cover the distribution
+		EXPECT_DOUBLE_EQ(7.69711747013104972, ZigguratExponential::getLayerEdge(1));
+		EXPECT_DOUBLE_EQ(0.0, ZigguratExponential::getLayerEdge(ZigguratExponential::N_layers));
+		double area = ZigguratExponential::getLayerEdge(0)*exp(-ZigguratExponential::getLayerEdge(1));
+		for (int i = 1; i < ZigguratExponential::N_layers; i++) {
+			EXPECT_NEAR(area, ZigguratExponential::getLayerEdge(i)*(exp(-ZigguratExponential::getLayerEdge(i + 1)) - exp(-ZigguratExponential::getLayerEdge(i))), 1e-12);
+		}
+		// Generate samples using the ziggurat method, the block version, and the logarithm method that it replaces
+		const int N_samples = 1000000;
+		Xoshiro256pp gen(1);
+		vector<double> data_zig(N_samples);
+		for (auto &item : data_zig) {
+			item = ZigguratExponential::generate(gen);
+		}
+		vector<double> data_block(N_samples);
+		ZigguratExponential::generateBlock(gen, data_block.data(), data_block.size());
+		vector<double> data_log(N_samples);
+		generateUniform01(gen, data_log.data(), data_log.size());
+		for (auto &item : data_log) {
+			item = -log(item);
+		}
+		EXPECT_GE(*min_element(data_zig.begin(), data_zig.end()), 0.0);
+		EXPECT_GE(*min_element(data_block.begin(), data_block.end()), 0.0);
+		// Check the mean and variance, which are both one for the exponential distribution
+		EXPECT_NEAR(1.0, vector_avg(data_zig), 5e-3);
+		EXPECT_NEAR(1.0, vector_avg(data_block), 5e-3);
+		EXPECT_NEAR(1.0, vector_stdev(data_zig), 5e-3);
+		EXPECT_NEAR(1.0, vector_stdev(data_block), 5e-3);
+		// Check that the tail beyond the base layer is sampled with the correct probability
+		double tail_fraction = count_if(data_zig.begin(), data_zig.end(), [](const double x) {return x > 7.69711747013104972; }) / (double)N_samples;
+		EXPECT_NEAR(exp(-7.69711747013104972), tail_fraction, 2e-4);
+		// Check the Kolmogorov-Smirnov statistics against the critical value for a significance level of 0.001
+		double critical_value = 1.95 / sqrt((double)N_samples);
+		EXPECT_LT(calculateExponentialKS(data_zig), critical_value);
+		EXPECT_LT(calculateExponentialKS(data_block), critical_value);
+		EXPECT_LT(calculateExponentialKS(data_log), critical_value);
+		// Check the two sample Kolmogorov-Smirnov statistic between the ziggurat and logarithm methods
+		sort(data_zig.begin(), data_zig.end());
+		sort(data_log.begin(), data_log.end());
+		double statistic = 0.0;
+		size_t i = 0;
+		size_t j = 0;
+		while (i < data_zig.size() && j < data_log.size()) {
+			if (data_zig[i] <= data_log[j]) {
+				i++;
+			}
+			else {
+				j++;
+			}
+			statistic = max(statistic, fabs((double)i / N_samples - (double)j / N_samples));
+		}
+		EXPECT_LT(statistic, 1.95*sqrt(2.0 / N_samples));
+		// Check that the block version works with 32-bit engines and partial blocks
+		Philox4x32 gen_philox(3);
+		vector<double> data_philox(100001);
+		ZigguratExponential::generateBlock(gen_philox, data_philox.data(), data_philox.size());
+		EXPECT_NEAR(1.0, vector_avg(data_philox), 2e-2);
+	}
+
+	TEST(RandomTests, Xoshiro256ppTests) {
+		// Check the splitmix64 sequence used to seed the state
+		uint64_t state = 0;
+		EXPECT_EQ(0xe220a8397b1dcdafULL, Xoshiro256pp::calculateSplitMix64(state));
+		EXPECT_EQ(0x6e789e6aa1b965f4ULL, Xoshiro256pp::calculateSplitMix64(state));
+		EXPECT_EQ(0x06c45d188009454fULL, Xoshiro256pp::calculateSplitMix64(state));
+		// Check the first outputs for a seed of zero
+		Xoshiro256pp gen;
+		EXPECT_EQ(0x53175d61490b23dfULL, gen());
+		EXPECT_EQ(0x61da6f3dc380d507ULL, gen());
+		EXPECT_EQ(0x5c0fdf91ec9a7bfcULL, gen());
+		gen.seed(0);
+		EXPECT_EQ(0x53175d61490b23dfULL, gen());
+		// Check that the engine works with the standard library distributions
+		gen.seed(1);
+		uniform_real_distribution<double> dist(0.0, 1.0);
+		double sum = 0.0;
+		for (int n = 0; n < 1000000; n++) {
+			sum += dist(gen);
+		}
+		EXPECT_NEAR(0.5, sum / 1000000, 2e-3);
+	}
+}
+
 namespace EventTests {
 
 	class EventTest : public ::testing::Test {
@@ -1473,6 +3284,12 @@ namespace EventTests {
 		EXPECT_EQ(&object2, event.getObjectTargetPtr());
 		event.setDestCoords(coords2);
 		EXPECT_EQ(coords2, event.getDestCoords());
+		EXPECT_EQ(-1, event.getDestSiteIndex());
+		event.setDestCoords(coords2, 2500);
+		EXPECT_EQ(coords2, event.getDestCoords());
+		EXPECT_EQ(2500, event.getDestSiteIndex());
+		event.setDestCoords(coords1);
+		EXPECT_EQ(-1, event.getDestSiteIndex());
 		EXPECT_FALSE(event.setExecutionTime(-1.0));
 		EXPECT_TRUE(event.setExecutionTime(1.0));
 		EXPECT_DOUBLE_EQ(1.0, event.getExecutionTime());
@@ -1538,6 +3355,15 @@ namespace ObjectTests {
 		event_ptrs.push_back(&event);
 		object1.setEventIt(event_ptrs.begin());
 		EXPECT_EQ(&event, *(object1.getEventIt()));
+		// Site index tests
+		EXPECT_EQ(-1, object1.getSiteIndex());
+		object1.setSiteIndex(0);
+		EXPECT_EQ(0, object1.getSiteIndex());
+		object1.setCoords(Coords(1, 0, 0), 2500);
+		EXPECT_EQ(Coords(1, 0, 0), object1.getCoords());
+		EXPECT_EQ(2500, object1.getSiteIndex());
+		object1.setCoords(Coords(2, 0, 0));
+		EXPECT_EQ(-1, object1.getSiteIndex());
 	}
 
 	TEST(ObjectTests, CalculateDisplacementTests) {
@@ -1584,6 +3410,146 @@ namespace ObjectTests {
 
 }
 
+namespace MSDAccumulatorTests {
+
+	TEST(MSDAccumulatorTests, AccumulationTests) {
+		MSDAccumulator accumulator;
+		EXPECT_EQ(0, accumulator.getNumSampleTimes());
+		EXPECT_THROW(accumulator.init(0.0, 1.0, 2), invalid_argument);
+		EXPECT_THROW(accumulator.init(1.0, 0.1, 2), invalid_argument);
+		EXPECT_THROW(accumulator.init(1e-3, 1e-1, 0), invalid_argument);
+		accumulator.init(1e-3, 1e-1, 2);
+		auto sample_times = accumulator.getSampleTimes();
+		ASSERT_EQ(5, (int)sample_times.size());
+		EXPECT_DOUBLE_EQ(1e-3, sample_times[0]);
+		EXPECT_DOUBLE_EQ(1e-3 * sqrt(10.0), sample_times[1]);
+		EXPECT_NEAR(1e-1, sample_times[4], 1e-15);
+		EXPECT_TRUE(accumulator.calculateMeanSquaredDisplacements().empty());
+		// Record the displacement of one object for the first three sample times and another object for the first sample time
+		EXPECT_EQ(0, accumulator.recordDisplacement(0, 5e-4, 1, 0, 0));
+		EXPECT_EQ(3, accumulator.recordDisplacement(0, 1.5e-2, 1, 2, 0));
+		EXPECT_EQ(1, accumulator.recordDisplacement(0, 2e-3, 0, 0, 3));
+		EXPECT_EQ(3, accumulator.recordDisplacement(3, 2e-2, 1, 1, 1));
+		EXPECT_EQ(5, accumulator.recordDisplacement(3, 1.0, 2, 2, 2));
+		EXPECT_EQ(5, accumulator.recordDisplacement(5, 2.0, 4, 4, 4));
+		auto counts = accumulator.getSampleCounts();
+		vector<int64_t> counts_expected = { 2, 1, 1, 1, 1 };
+		EXPECT_TRUE(counts == counts_expected);
+		auto msd_data = accumulator.calculateMeanSquaredDisplacements();
+		ASSERT_EQ(5, (int)msd_data.size());
+		EXPECT_DOUBLE_EQ(1e-3, msd_data[0].first);
+		EXPECT_DOUBLE_EQ(7.0, msd_data[0].second);
+		EXPECT_DOUBLE_EQ(5.0, msd_data[2].second);
+		EXPECT_DOUBLE_EQ(12.0, msd_data[4].second);
+		EXPECT_DOUBLE_EQ(0.5, accumulator.calculateMeanSquaredDisplacements(1)[0].second);
+		EXPECT_DOUBLE_EQ(2.0, accumulator.calculateMeanSquaredDisplacements(2)[0].second);
+		EXPECT_DOUBLE_EQ(4.5, accumulator.calculateMeanSquaredDisplacements(3)[0].second);
+		EXPECT_THROW(accumulator.calculateMeanSquaredDisplacements(4), invalid_argument);
+		// Check the diffusion coefficient in cm^2 s^-1
+		auto diffusion_data = accumulator.calculateDiffusionCoefficients(2.0, 3);
+		EXPECT_DOUBLE_EQ(12.0 * 4e-14 / (6.0 * sample_times[4]), diffusion_data[4].second);
+		diffusion_data = accumulator.calculateDiffusionCoefficients(1.0, 1);
+		EXPECT_DOUBLE_EQ(7.0 * 1e-14 / (2.0 * 1e-3), diffusion_data[0].second);
+		EXPECT_THROW(accumulator.calculateDiffusionCoefficients(0.0, 3), invalid_argument);
+		EXPECT_THROW(accumulator.calculateDiffusionCoefficients(1.0, 4), invalid_argument);
+		// Check that merged accumulators combine the samples
+		MSDAccumulator accumulator2;
+		accumulator2.init(1e-3, 1e-1, 2);
+		accumulator2.addSample(0, 3, 0, 0);
+		accumulator2.addSample(1, 0, 0, 0);
+		accumulator.merge(accumulator2);
+		counts_expected = { 3, 2, 1, 1, 1 };
+		EXPECT_TRUE(accumulator.getSampleCounts() == counts_expected);
+		EXPECT_DOUBLE_EQ(23.0 / 3.0, accumulator.calculateMeanSquaredDisplacements()[0].second);
+		EXPECT_DOUBLE_EQ(2.5, accumulator.calculateMeanSquaredDisplacements()[1].second);
+		MSDAccumulator accumulator3;
+		accumulator3.init(1e-3, 1e-1, 4);
+		EXPECT_THROW(accumulator.merge(accumulator3), invalid_argument);
+		// Check that clearing the accumulator keeps the sample times
+		accumulator.clear();
+		EXPECT_EQ(5, accumulator.getNumSampleTimes());
+		EXPECT_TRUE(accumulator.calculateMeanSquaredDisplacements().empty());
+	}
+
+}
+
+namespace ObjectStoreTests {
+
+	TEST(ObjectStoreTests, AddMoveRemoveTests) {
+		ObjectStore store;
+		EXPECT_EQ(0, store.size());
+		EXPECT_DOUBLE_EQ(0.0, store.calculateMeanSquaredDisplacement());
+		vector<Object> objects;
+		for (int n = 0; n < 10; n++) {
+			objects.push_back(Object(0.1*n, n, Coords(n, 2 * n, 3 * n)));
+		}
+		store.reserve(objects.size());
+		for (auto& item : objects) {
+			EXPECT_EQ(item.getTag(), store.addObject(&item));
+			EXPECT_EQ(item.getTag(), item.getStoreIndex());
+		}
+		EXPECT_EQ(10, store.size());
+		EXPECT_DOUBLE_EQ(0.5, store.getCreationTimes()[5]);
+		EXPECT_EQ(7, store.getTags()[7]);
+		EXPECT_EQ(4, store.getY()[2]);
+		EXPECT_DOUBLE_EQ(0.0, store.calculateMeanSquaredDisplacement());
+		// Move objects in the same way as the Simulation moveObject function, including periodic boundary crossings
+		Coords image_shift(0, 0, 0);
+		store.moveObject(objects[1].getStoreIndex(), Coords(2, 2, 3), image_shift);
+		objects[1].moveTo(Coords(2, 2, 3), -1, image_shift);
+		image_shift = Coords(-50, 0, 0);
+		store.moveObject(objects[0].getStoreIndex(), Coords(49, 0, 0), image_shift);
+		objects[0].moveTo(Coords(49, 0, 0), -1, image_shift);
+		image_shift = Coords(0, 50, 50);
+		store.moveObject(objects[3].getStoreIndex(), Coords(3, 0, 0), image_shift);
+		objects[3].moveTo(Coords(3, 0, 0), -1, image_shift);
+		for (auto const &item : objects) {
+			int64_t index = item.getStoreIndex();
+			EXPECT_EQ(item.getCoords(), Coords(store.getX()[index], store.getY()[index], store.getZ()[index]));
+			EXPECT_DOUBLE_EQ(item.calculateDisplacement(1), store.getNetX()[index]);
+			EXPECT_DOUBLE_EQ(item.calculateDisplacement(2), store.getNetY()[index]);
+			EXPECT_DOUBLE_EQ(item.calculateDisplacement(3), store.getNetZ()[index]);
+		}
+		// Check the displacement kernels
+		vector<double> squared_displacements;
+		store.calculateSquaredDisplacements(squared_displacements);
+		ASSERT_EQ(10, (int)squared_displacements.size());
+		EXPECT_DOUBLE_EQ(1.0, squared_displacements[0]);
+		EXPECT_DOUBLE_EQ(1.0, squared_displacements[1]);
+		EXPECT_DOUBLE_EQ(44.0 * 44 + 41.0 * 41, squared_displacements[3]);
+		EXPECT_DOUBLE_EQ((1.0 + 1.0 + 44.0 * 44 + 41.0 * 41) / 10, store.calculateMeanSquaredDisplacement());
+		EXPECT_DOUBLE_EQ((1.0 + 1.0) / 10, store.calculateMeanSquaredDisplacement(1));
+		EXPECT_DOUBLE_EQ(44.0 * 44 / 10, store.calculateMeanSquaredDisplacement(2));
+		EXPECT_DOUBLE_EQ(41.0 * 41 / 10, store.calculateMeanSquaredDisplacement(3));
+		EXPECT_THROW(store.calculateMeanSquaredDisplacement(4), invalid_argument);
+		// Remove objects and check that the order and the saved positions are kept consistent
+		store.removeObject(&objects[3]);
+		EXPECT_EQ(-1, objects[3].getStoreIndex());
+		EXPECT_EQ(9, store.size());
+		EXPECT_DOUBLE_EQ(2.0 / 9, store.calculateMeanSquaredDisplacement());
+		EXPECT_THROW(store.removeObject(&objects[3]), invalid_argument);
+		store.removeObjects(vector<Object*>{ &objects[0], &objects[5], &objects[9] });
+		EXPECT_EQ(6, store.size());
+		vector<int> tags_expected = { 1, 2, 4, 6, 7, 8 };
+		EXPECT_TRUE(store.getTags() == tags_expected);
+		for (int64_t i = 0; i < store.size(); i++) {
+			EXPECT_EQ(i, store.getObjectPtrs()[i]->getStoreIndex());
+			EXPECT_EQ(store.getObjectPtrs()[i]->getTag(), store.getTags()[i]);
+			EXPECT_EQ(store.getObjectPtrs()[i]->getCoords().x, store.getX()[i]);
+		}
+		EXPECT_THROW(store.removeObjects(vector<Object*>{ &objects[0] }), invalid_argument);
+		// Check that changes made directly to an Object can be copied into the store
+		objects[2].resetInitialCoords(Coords(10, 10, 10));
+		store.updateObject(&objects[2]);
+		EXPECT_EQ(-8, store.getNetX()[objects[2].getStoreIndex()]);
+		EXPECT_THROW(store.updateObject(&objects[0]), invalid_argument);
+		store.clear();
+		EXPECT_EQ(0, store.size());
+		EXPECT_THROW(store.updateObject(&objects[2]), invalid_argument);
+	}
+
+}
+
 namespace VersionTests {
 
 	TEST(VersionTests, ConstructorTests) {
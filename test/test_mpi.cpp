@@ -4,6 +4,7 @@
 // The KMC_Lattice project can be found on Github at https://github.com/MikeHeiber/KMC_Lattice
 
 #include "gtest/gtest.h"
+#include "MSDAccumulator.h"
 #include "Utils.h"
 #include <mpi.h>
 
@@ -265,6 +266,41 @@ namespace MPI_Tests {
 			}
 		}
 	}
+
+	TEST_F(MPI_Test, MergeMSDAccumulatorTests) {
+		// Add different samples on each proc
+		MSDAccumulator accumulator;
+		accumulator.init(1e-3, 1e-1, 1);
+		accumulator.addSample(0, procid + 1, 0, 0);
+		accumulator.addSample(2, 1, 1, procid);
+		accumulator.addSample(2, 0, 0, 0);
+		accumulator.MPI_merge();
+		if (procid == 0) {
+			vector<int64_t> counts_expected = { nproc, 0, 2 * nproc };
+			EXPECT_TRUE(accumulator.getSampleCounts() == counts_expected);
+			auto msd_data = accumulator.calculateMeanSquaredDisplacements();
+			ASSERT_EQ(2, (int)msd_data.size());
+			double sum_sq_first = 0.0;
+			double sum_sq_last = 0.0;
+			for (int i = 0; i < nproc; i++) {
+				sum_sq_first += (i + 1)*(i + 1);
+				sum_sq_last += 2 + i * i;
+			}
+			EXPECT_DOUBLE_EQ(sum_sq_first / nproc, msd_data[0].second);
+			EXPECT_DOUBLE_EQ(1e-1, msd_data[1].first);
+			EXPECT_DOUBLE_EQ(sum_sq_last / (2 * nproc), msd_data[1].second);
+		}
+		else {
+			vector<int64_t> counts_expected = { 1, 0, 2 };
+			EXPECT_TRUE(accumulator.getSampleCounts() == counts_expected);
+		}
+		// Check that accumulators with different sample times cannot be merged
+		if (nproc > 1) {
+			MSDAccumulator accumulator2;
+			accumulator2.init(1e-3, (procid == 0) ? 1e-1 : 1.0, 1);
+			EXPECT_THROW(accumulator2.MPI_merge(), invalid_argument);
+		}
+	}
 }
 
 int main(int argc, char **argv) {